@@ -0,0 +1,56 @@
+/*
+    Unitemp - Universal temperature reader
+    Copyright (C) 2022-2026  Victor Nikitchuk (https://github.com/quen0n)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#ifndef UNITEMP_CRC_H_
+#define UNITEMP_CRC_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief Maxim/Dallas CRC8 (polynomial 0x31 reflected, initial value 0x00). Used by 1-Wire devices
+ * @param data Pointer to data
+ * @param len Number of bytes
+ * @return Checksum. Zero when calculated over data with its CRC byte
+ */
+uint8_t unitemp_crc8_maxim(const uint8_t* data, size_t len);
+
+/**
+ * @brief Sensirion CRC8 (polynomial 0x31, initial value 0xFF). Used by SHTxx, SCDxx and AHT/DHT20
+ * @param data Pointer to data
+ * @param len Number of bytes
+ * @return Checksum
+ */
+uint8_t unitemp_crc8_sensirion(const uint8_t* data, size_t len);
+
+/**
+ * @brief HTU21 CRC8 (polynomial 0x131, initial value 0x00)
+ * @param data Pointer to data
+ * @param len Number of bytes
+ * @return Checksum
+ */
+uint8_t unitemp_crc8_htu(const uint8_t* data, size_t len);
+
+/**
+ * @brief Modbus CRC16 (polynomial 0xA001 reflected, initial value 0xFFFF). Used by AM2320
+ * @param data Pointer to data
+ * @param len Number of bytes
+ * @return Checksum
+ */
+uint16_t unitemp_crc16_modbus(const uint8_t* data, size_t len);
+
+#endif
@@ -38,144 +38,205 @@ static const SensorGpioPin gpio_list[] = {
     {16, "16 (C0)", &gpio_ext_pc0},
     {17, "17 (1W)", &gpio_ibutton}};
 
-// List of interfaces that are attached to GPIO(defined by index)
-//NULL - port is free, pointer to interface - port is occupied by this interface
+//External interrupt lines of the buttons: Ok (PH3), Down (PC6), Up (PB10), Left (PB11),
+//Right (PB12), Back (PC13)
+#define GPIO_EXTI_SYSTEM_LINES                                                          \
+    (LL_GPIO_PIN_3 | LL_GPIO_PIN_6 | LL_GPIO_PIN_10 | LL_GPIO_PIN_11 | LL_GPIO_PIN_12 | \
+     LL_GPIO_PIN_13)
+
+//Pins by their number on the case, NULL if the number has no usable pin
+#define GPIO_NUMBER_MAX 17
+static const SensorGpioPin* const gpio_by_number[GPIO_NUMBER_MAX + 1] = {
+    [2] = &gpio_list[0],
+    [3] = &gpio_list[1],
+    [4] = &gpio_list[2],
+    [5] = &gpio_list[3],
+    [6] = &gpio_list[4],
+    [7] = &gpio_list[5],
+    [10] = &gpio_list[6],
+    [12] = &gpio_list[7],
+    [13] = &gpio_list[8],
+    [14] = &gpio_list[9],
+    [15] = &gpio_list[10],
+    [16] = &gpio_list[11],
+    [17] = &gpio_list[12]};
+
+//Bit of the pin in the masks (by index in gpio_list)
+#define GPIO_BIT(index)   (1U << (index))
+#define GPIO_ALL_MASK     (GPIO_BIT(SENSOR_PINS_COUNT) - 1)
+//SPI bus pins: MOSI (2), MISO (3), SCK (5)
+#define GPIO_SPI_BUS_MASK (GPIO_BIT(0) | GPIO_BIT(1) | GPIO_BIT(3))
+
+//Interfaces and sensors that occupy the pins (by index)
+//NULL interface - the pin is free, NULL sensor - the pin belongs to a bus of several sensors
 static const SensorConnectionInterface* gpio_interfaces_list[SENSOR_PINS_COUNT] = {0};
+static const Sensor* gpio_owners_list[SENSOR_PINS_COUNT] = {0};
+//Pins occupied by any interface
+static uint16_t gpio_locked_mask = 0;
+//Pins occupied by the interfaces whose pins can be shared with a new sensor
+static uint16_t gpio_onewire_mask = 0;
+static uint16_t gpio_spi_mask = 0;
+
+/**
+ * @brief Get the index of the pin in the list
+ * @param gpio Pointer to port from the list
+ * @return Pin index
+ */
+static inline uint8_t unitemp_gpio_to_index(const SensorGpioPin* gpio) {
+    return gpio - gpio_list;
+}
 
 const SensorGpioPin* unitemp_gpio_get_from_int(uint8_t number) {
-    for(uint8_t i = 0; i < SENSOR_PINS_COUNT; i++) {
-        if(gpio_list[i].num == number) {
-            return &gpio_list[i];
-        }
-    }
-    return NULL;
+    if(number > GPIO_NUMBER_MAX) return NULL;
+    return gpio_by_number[number];
 }
 
 const SensorGpioPin* unitemp_gpio_get_from_index(uint8_t index) {
     return &gpio_list[index];
 }
 
-uint8_t unitemp_gpio_to_index(const GpioPin* gpio) {
-    if(gpio == NULL) return 255;
-
-    for(uint8_t i = 0; i < SENSOR_PINS_COUNT; i++) {
-        if(gpio_list[i].pin->pin == gpio->pin && gpio_list[i].pin->port == gpio->port) {
-            return i;
-        }
-    }
-
-    return 255;
+uint8_t unitemp_gpio_get_count(void) {
+    return SENSOR_PINS_COUNT;
 }
 
-void unitemp_gpio_lock(const SensorGpioPin* gpio, const SensorConnectionInterface* interface) {
+void unitemp_gpio_lock(
+    const SensorGpioPin* gpio,
+    const SensorConnectionInterface* interface,
+    const Sensor* owner) {
     furi_check(gpio);
     furi_check(interface);
 
-    uint8_t i = unitemp_gpio_to_index(gpio->pin);
-    if(i == 255) return;
+    uint8_t i = unitemp_gpio_to_index(gpio);
     gpio_interfaces_list[i] = interface;
+    gpio_owners_list[i] = owner;
+    gpio_locked_mask |= GPIO_BIT(i);
+    gpio_onewire_mask &= ~GPIO_BIT(i);
+    gpio_spi_mask &= ~GPIO_BIT(i);
+    if(interface == &unitemp_1w) gpio_onewire_mask |= GPIO_BIT(i);
+    if(interface == &unitemp_spi) gpio_spi_mask |= GPIO_BIT(i);
     UNITEMP_DEBUG("%s has been locked for interface %s", gpio->name, interface->name);
 }
 
 void unitemp_gpio_unlock(const SensorGpioPin* gpio) {
     furi_check(gpio);
 
-    uint8_t i = unitemp_gpio_to_index(gpio->pin);
-    if(i == 255) return;
+    uint8_t i = unitemp_gpio_to_index(gpio);
     gpio_interfaces_list[i] = NULL;
+    gpio_owners_list[i] = NULL;
+    gpio_locked_mask &= ~GPIO_BIT(i);
+    gpio_onewire_mask &= ~GPIO_BIT(i);
+    gpio_spi_mask &= ~GPIO_BIT(i);
     UNITEMP_DEBUG("%s has been unlocked", gpio->name);
 }
 
+const SensorConnectionInterface* unitemp_gpio_get_interface(const SensorGpioPin* gpio) {
+    if(gpio == NULL) return NULL;
+    return gpio_interfaces_list[unitemp_gpio_to_index(gpio)];
+}
+
+const Sensor* unitemp_gpio_get_owner(const SensorGpioPin* gpio) {
+    if(gpio == NULL) return NULL;
+    return gpio_owners_list[unitemp_gpio_to_index(gpio)];
+}
+
+/**
+ * @brief Get the mask of the pins available for the interface
+ * @param interface Pointer to interface (except I2C)
+ * @param extraport Pointer to an additional port that will be forced to be considered available
+ * @return Pin mask
+ */
+static uint16_t unitemp_gpio_get_aviable_mask(
+    const SensorConnectionInterface* interface,
+    const SensorGpioPin* extraport) {
+    uint16_t free_mask = ~gpio_locked_mask & GPIO_ALL_MASK;
+    uint16_t mask = 0;
+    if(interface == &unitemp_1w) {
+        //Sensors on the same pin share the bus
+        mask = free_mask | gpio_onewire_mask;
+    } else if(interface == &unitemp_singlewire) {
+        mask = free_mask;
+    } else if(interface == &unitemp_spi) {
+        //The bus pins must be free or already belong to the SPI bus
+        if((GPIO_SPI_BUS_MASK & ~(free_mask | gpio_spi_mask)) != 0) return 0;
+        mask = free_mask & ~GPIO_SPI_BUS_MASK;
+    }
+    if(extraport != NULL) mask |= GPIO_BIT(unitemp_gpio_to_index(extraport));
+    return mask;
+}
+
 const SensorGpioPin* unitemp_gpio_get_aviable_pin(
     const SensorConnectionInterface* interface,
     uint8_t index,
     const SensorGpioPin* extraport) {
-    //Check for I2C
+    //Check for I2C: the main bus or two free pins for a software bus
     if(interface == &unitemp_i2c) {
-        if((gpio_interfaces_list[10] == NULL || gpio_interfaces_list[10] == &unitemp_i2c) &&
-           (gpio_interfaces_list[11] == NULL || gpio_interfaces_list[11] == &unitemp_i2c)) {
-            //Return some true
-            return unitemp_gpio_get_from_index(0);
-        } else {
-            return NULL;
-        }
-    }
-    if(interface == &unitemp_spi) {
-        if(!((gpio_interfaces_list[0] == NULL || gpio_interfaces_list[0] == &unitemp_spi) &&
-             (gpio_interfaces_list[1] == NULL || gpio_interfaces_list[1] == &unitemp_spi) &&
-             (gpio_interfaces_list[3] == NULL || gpio_interfaces_list[3] == &unitemp_spi))) {
-            return NULL;
-        }
+        const SensorGpioPin* sda_pin;
+        const SensorGpioPin* scl_pin;
+        return unitemp_i2c_get_free_pins(&sda_pin, &scl_pin) ? sda_pin : NULL;
     }
 
-    uint8_t aviable_index = 0;
+    uint16_t mask = unitemp_gpio_get_aviable_mask(interface, extraport);
     for(uint8_t i = 0; i < SENSOR_PINS_COUNT; i++) {
-        //Check for one wire
-        if(interface == &unitemp_1w) {
-            if(((gpio_interfaces_list[i] == NULL || gpio_interfaces_list[i] == &unitemp_1w)) ||
-               (unitemp_gpio_get_from_index(i) == extraport)) {
-                if(aviable_index == index) {
-                    return unitemp_gpio_get_from_index(i);
-                } else {
-                    aviable_index++;
-                }
-            }
-        }
-        //Check for single wire dataline
-        if(interface == &unitemp_singlewire) {
-            if(gpio_interfaces_list[i] == NULL || unitemp_gpio_get_from_index(i) == extraport) {
-                if(aviable_index == index) {
-                    return unitemp_gpio_get_from_index(i);
-                } else {
-                    aviable_index++;
-                }
-            }
-        }
-        //Check for SPI CS
-        if(interface == &unitemp_spi) {
-            if((gpio_interfaces_list[i] == NULL || unitemp_gpio_get_from_index(i) == extraport) &&
-               i != 0 && i != 1 && i != 3) {
-                if(aviable_index == index) {
-                    return unitemp_gpio_get_from_index(i);
-                } else {
-                    aviable_index++;
-                }
-            }
-        }
+        if((mask & GPIO_BIT(i)) == 0) continue;
+        if(index == 0) return &gpio_list[i];
+        index--;
     }
-
     return NULL;
 }
 
 uint8_t unitemp_gpio_get_aviable_pin_count(
     const SensorConnectionInterface* interface,
     const SensorGpioPin* extraport) {
-    uint8_t aviable_ports_count = 0;
-    for(uint8_t i = 0; i < SENSOR_PINS_COUNT; i++) {
-        //Check for one wire
-        if(interface == &unitemp_1w) {
-            if(((gpio_interfaces_list[i] == NULL || gpio_interfaces_list[i] == &unitemp_1w)) ||
-               (unitemp_gpio_get_from_index(i) == extraport)) {
-                aviable_ports_count++;
-            }
-        }
+    if(interface == &unitemp_i2c) {
+        const SensorGpioPin* sda_pin;
+        const SensorGpioPin* scl_pin;
+        return unitemp_i2c_get_free_pins(&sda_pin, &scl_pin) ? 2 : 0;
+    }
+    return __builtin_popcount(unitemp_gpio_get_aviable_mask(interface, extraport));
+}
 
-        //Check for single wire
-        if(interface == &unitemp_singlewire || interface == &unitemp_spi) {
-            if(gpio_interfaces_list[i] == NULL || (unitemp_gpio_get_from_index(i) == extraport)) {
-                UNITEMP_DEBUG("%s pin is aviable", unitemp_gpio_get_from_index(i)->name);
-                aviable_ports_count++;
-            }
-        }
+/**
+ * @brief Describe who occupies the pin
+ * @param gpio Pointer to port
+ * @param text Buffer for the message
+ * @param size Buffer size
+ */
+static void unitemp_gpio_describe_owner(const SensorGpioPin* gpio, char* text, size_t size) {
+    uint8_t i = unitemp_gpio_to_index(gpio);
+    if(gpio_owners_list[i] != NULL) {
+        snprintf(text, size, "%s\nis used by\n%s", gpio->name, gpio_owners_list[i]->name);
+    } else {
+        snprintf(
+            text, size, "%s\nis used by\n%s bus", gpio->name, gpio_interfaces_list[i]->name);
+    }
+}
 
-        if(interface == &unitemp_i2c) {
-            if((gpio_interfaces_list[10] == NULL || gpio_interfaces_list[10] == &unitemp_i2c) &&
-               (gpio_interfaces_list[11] == NULL || gpio_interfaces_list[11] == &unitemp_i2c)) {
-                return 2;
-            } else {
-                return 0;
-            }
+bool unitemp_gpio_get_conflict(
+    const SensorConnectionInterface* interface,
+    char* text,
+    size_t size) {
+    uint16_t busy_mask = 0;
+    if(interface == &unitemp_spi) {
+        busy_mask = GPIO_SPI_BUS_MASK & gpio_locked_mask & ~gpio_spi_mask;
+    } else if(interface == &unitemp_i2c) {
+        const SensorGpioPin* sda = unitemp_gpio_get_from_int(UNITEMP_I2C_MAIN_SDA_PIN);
+        const SensorGpioPin* scl = unitemp_gpio_get_from_int(UNITEMP_I2C_MAIN_SCL_PIN);
+        if(unitemp_gpio_get_interface(sda) != &unitemp_i2c) {
+            busy_mask |= GPIO_BIT(unitemp_gpio_to_index(sda));
+        }
+        if(unitemp_gpio_get_interface(scl) != &unitemp_i2c) {
+            busy_mask |= GPIO_BIT(unitemp_gpio_to_index(scl));
         }
+        busy_mask &= gpio_locked_mask;
     }
-    return aviable_ports_count;
+    if(busy_mask == 0) return false;
+
+    //The first pin that blocks the bus
+    unitemp_gpio_describe_owner(&gpio_list[__builtin_ctz(busy_mask)], text, size);
+    return true;
+}
+
+bool unitemp_gpio_exti_available(const SensorGpioPin* gpio) {
+    if(gpio == NULL) return false;
+    return (gpio->pin->pin & GPIO_EXTI_SYSTEM_LINES) == 0;
 }
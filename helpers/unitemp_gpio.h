@@ -38,8 +38,12 @@ const SensorGpioPin* unitemp_gpio_get_from_int(uint8_t number);
  * @brief Locking GPIO by specified interface
  * @param gpio Pointer to port
  * @param interface Pointer to the interface on which the port will be occupied
+ * @param owner Pointer to the sensor that occupies the port, NULL for a bus shared by sensors
  */
-void unitemp_gpio_lock(const SensorGpioPin* gpio, const SensorConnectionInterface* interface);
+void unitemp_gpio_lock(
+    const SensorGpioPin* gpio,
+    const SensorConnectionInterface* interface,
+    const Sensor* owner);
 
 /**
  * @brief Unlocking the port
@@ -70,4 +74,49 @@ uint8_t unitemp_gpio_get_aviable_pin_count(
 
 const SensorGpioPin* unitemp_gpio_get_from_index(uint8_t index);
 
+/**
+ * @brief Get the number of pins in the list
+ * @return Number of pins
+ */
+uint8_t unitemp_gpio_get_count(void);
+
+/**
+ * @brief Get the interface that occupies the port
+ * @param gpio Pointer to port
+ * @return Pointer to interface, NULL if the port is free
+ */
+const SensorConnectionInterface* unitemp_gpio_get_interface(const SensorGpioPin* gpio);
+
+/**
+ * @brief Get the sensor that occupies the port
+ * @param gpio Pointer to port
+ * @return Pointer to sensor, NULL if the port is free or belongs to a shared bus
+ */
+const Sensor* unitemp_gpio_get_owner(const SensorGpioPin* gpio);
+
+/**
+ * @brief Describe the pin that prevents adding a sensor with the interface
+ * 
+ * The bus pins of SPI and the main I2C bus can be taken by other interfaces.
+ * The message names the pin and the sensor or the bus that occupies it.
+ * @param interface Pointer to interface
+ * @param text Buffer for the message
+ * @param size Buffer size
+ * @return True if a bus pin is occupied, false if there are no free pins at all
+ */
+bool unitemp_gpio_get_conflict(
+    const SensorConnectionInterface* interface,
+    char* text,
+    size_t size);
+
+/**
+ * @brief Check that the external interrupt line of the pin is not used by the system
+ * 
+ * The lines are shared by the pins with the same number on all ports,
+ * the buttons take some of them.
+ * @param gpio Pointer to port
+ * @return True if an interrupt callback can be added to the pin
+ */
+bool unitemp_gpio_exti_available(const SensorGpioPin* gpio);
+
 #endif //UNITEMP_GPIO_H_
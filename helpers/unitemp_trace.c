@@ -0,0 +1,412 @@
+/*
+    Unitemp - Universal temperature reader
+    Copyright (C) 2022-2026  Victor Nikitchuk (https://github.com/quen0n)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "unitemp_trace.h"
+#include "../unitemp.h"
+
+//Mode chosen in the settings
+static UnitempTraceMode trace_mode = UnitempTraceModeOff;
+//Mode of the running trace
+static UnitempTraceMode trace_state = UnitempTraceModeOff;
+
+static Storage* trace_storage = NULL;
+static File* trace_file = NULL;
+static FuriMutex* trace_mutex = NULL;
+
+//Records waiting to be written to the SD card. The replay reads the record data here
+static uint8_t trace_buffer[UNITEMP_TRACE_BUFFER_SIZE];
+static uint16_t trace_buffer_len = 0;
+//Size of the segment being written
+static uint32_t trace_segment_size = 0;
+
+//Replay position of a device: the segment and the offset of its next record
+typedef struct {
+    UnitempTraceBus bus;
+    uint8_t addr;
+    //0 for the previous segment, 1 for the newest one, 2 at the end of the trace
+    uint8_t segment;
+    uint32_t offset;
+} UnitempTraceCursor;
+
+//Segments being replayed, NULL if the segment is missing
+static File* trace_segments[2] = {NULL, NULL};
+//Every device is replayed from its own cursor, so the order of the polls does not matter
+static UnitempTraceCursor trace_cursors[UNITEMP_TRACE_CURSORS_MAX];
+static uint8_t trace_cursors_count = 0;
+//Number of the replayed transactions
+static uint32_t trace_replayed = 0;
+//Number of the transactions that differ from the trace
+static uint32_t trace_mismatches = 0;
+//The first mismatch has been reported
+static bool trace_mismatch_logged = false;
+
+static const uint8_t trace_magic[4] = {'U', 'T', 'R', UNITEMP_TRACE_VERSION};
+
+void unitemp_trace_set_mode(UnitempTraceMode mode) {
+    trace_mode = mode;
+}
+
+UnitempTraceMode unitemp_trace_get_mode(void) {
+    return trace_mode;
+}
+
+void unitemp_trace_clear(Storage* storage) {
+    storage_common_remove(storage, APP_DATA_PATH(UNITEMP_TRACE_FILENAME));
+    storage_common_remove(storage, APP_DATA_PATH(UNITEMP_TRACE_OLD_FILENAME));
+}
+
+/**
+ * @brief Open the newest segment for appending the records
+ * @return True if the segment is opened
+ */
+static bool unitemp_trace_open_segment(void) {
+    if(!storage_file_open(
+           trace_file, APP_DATA_PATH(UNITEMP_TRACE_FILENAME), FSAM_WRITE, FSOM_OPEN_APPEND)) {
+        return false;
+    }
+    trace_segment_size = storage_file_size(trace_file);
+    if(trace_segment_size == 0) {
+        if(storage_file_write(trace_file, trace_magic, sizeof(trace_magic)) !=
+           sizeof(trace_magic)) {
+            return false;
+        }
+        trace_segment_size = sizeof(trace_magic);
+    }
+    return true;
+}
+
+/**
+ * @brief Make the newest segment the previous one and start a new segment
+ * @return True if the new segment is opened
+ */
+static bool unitemp_trace_rotate(void) {
+    storage_file_close(trace_file);
+    storage_common_remove(trace_storage, APP_DATA_PATH(UNITEMP_TRACE_OLD_FILENAME));
+    storage_common_rename(
+        trace_storage,
+        APP_DATA_PATH(UNITEMP_TRACE_FILENAME),
+        APP_DATA_PATH(UNITEMP_TRACE_OLD_FILENAME));
+    return unitemp_trace_open_segment();
+}
+
+/**
+ * @brief Open the segment for the replay
+ * @param old True for the previous segment, false for the newest one
+ * @return Pointer to the file of the segment, NULL if the segment is missing or has a wrong format
+ */
+static File* unitemp_trace_open_replay(bool old) {
+    const char* path = old ? APP_DATA_PATH(UNITEMP_TRACE_OLD_FILENAME) :
+                             APP_DATA_PATH(UNITEMP_TRACE_FILENAME);
+    File* file = storage_file_alloc(trace_storage);
+    if(storage_file_open(file, path, FSAM_READ, FSOM_OPEN_EXISTING)) {
+        uint8_t magic[sizeof(trace_magic)];
+        if(storage_file_read(file, magic, sizeof(magic)) == sizeof(magic) &&
+           memcmp(magic, trace_magic, sizeof(magic)) == 0) {
+            return file;
+        }
+        FURI_LOG_E(APP_NAME, "Trace %s has an unknown format", path);
+        storage_file_close(file);
+    }
+    storage_file_free(file);
+    return NULL;
+}
+
+/**
+ * @brief Close the segments of the replay
+ */
+static void unitemp_trace_close_replay(void) {
+    for(uint8_t i = 0; i < 2; i++) {
+        if(trace_segments[i] == NULL) continue;
+        storage_file_close(trace_segments[i]);
+        storage_file_free(trace_segments[i]);
+        trace_segments[i] = NULL;
+    }
+}
+
+bool unitemp_trace_start(Storage* storage) {
+    unitemp_trace_stop();
+    if(trace_mode == UnitempTraceModeOff) return true;
+
+    trace_storage = storage;
+
+    bool result;
+    if(trace_mode == UnitempTraceModeRecord) {
+        trace_file = storage_file_alloc(storage);
+        trace_buffer_len = 0;
+        result = unitemp_trace_open_segment();
+        if(!result) {
+            if(storage_file_is_open(trace_file)) storage_file_close(trace_file);
+            storage_file_free(trace_file);
+            trace_file = NULL;
+        }
+    } else {
+        trace_replayed = 0;
+        trace_mismatches = 0;
+        trace_mismatch_logged = false;
+        trace_cursors_count = 0;
+        //The trace that has wrapped around starts in the previous segment
+        trace_segments[0] = unitemp_trace_open_replay(true);
+        trace_segments[1] = unitemp_trace_open_replay(false);
+        result = trace_segments[0] != NULL || trace_segments[1] != NULL;
+    }
+    if(!result) {
+        FURI_LOG_E(APP_NAME, "Failed to open the bus trace");
+        return false;
+    }
+
+    trace_mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    trace_state = trace_mode;
+    FURI_LOG_I(
+        APP_NAME,
+        "Bus trace %s started",
+        trace_state == UnitempTraceModeRecord ? "recording" : "replay");
+    return true;
+}
+
+void unitemp_trace_stop(void) {
+    if(trace_state == UnitempTraceModeOff) return;
+
+    if(trace_state == UnitempTraceModeRecord) {
+        unitemp_trace_flush();
+        if(storage_file_is_open(trace_file)) storage_file_close(trace_file);
+        storage_file_free(trace_file);
+        trace_file = NULL;
+    } else {
+        FURI_LOG_I(
+            APP_NAME,
+            "Bus trace replay: %lu transactions, %lu mismatches",
+            trace_replayed,
+            trace_mismatches);
+        unitemp_trace_close_replay();
+    }
+    trace_state = UnitempTraceModeOff;
+
+    furi_mutex_free(trace_mutex);
+    trace_mutex = NULL;
+}
+
+/**
+ * @brief Write the buffered records to the segment. The trace mutex must be taken
+ */
+static void unitemp_trace_write_buffer(void) {
+    if(trace_buffer_len == 0) return;
+    if(trace_segment_size + trace_buffer_len > UNITEMP_TRACE_SEGMENT_SIZE) {
+        unitemp_trace_rotate();
+    }
+    if(storage_file_write(trace_file, trace_buffer, trace_buffer_len) == trace_buffer_len) {
+        trace_segment_size += trace_buffer_len;
+        //The records must survive the power loss of the field unit
+        storage_file_sync(trace_file);
+    } else {
+        FURI_LOG_E(APP_NAME, "Failed to write the bus trace");
+    }
+    trace_buffer_len = 0;
+}
+
+void unitemp_trace_flush(void) {
+    if(trace_state != UnitempTraceModeRecord) return;
+
+    furi_mutex_acquire(trace_mutex, FuriWaitForever);
+    unitemp_trace_write_buffer();
+    furi_mutex_release(trace_mutex);
+}
+
+bool unitemp_trace_is_replaying(void) {
+    return trace_state == UnitempTraceModeReplay;
+}
+
+void unitemp_trace_record(
+    UnitempTraceBus bus,
+    UnitempTraceDir dir,
+    uint8_t addr,
+    uint8_t reg,
+    const uint8_t* data,
+    uint8_t len,
+    uint8_t result) {
+    if(trace_state != UnitempTraceModeRecord) return;
+    uint32_t tick = furi_get_tick();
+
+    furi_mutex_acquire(trace_mutex, FuriWaitForever);
+    //Long sequences (1-Wire search) are written without waiting for the end of the cycle
+    if(trace_buffer_len + UNITEMP_TRACE_HEADER_SIZE + len > UNITEMP_TRACE_BUFFER_SIZE) {
+        unitemp_trace_write_buffer();
+    }
+    uint8_t* record = &trace_buffer[trace_buffer_len];
+    record[0] = tick;
+    record[1] = tick >> 8;
+    record[2] = tick >> 16;
+    record[3] = tick >> 24;
+    record[4] = (bus << 4) | dir;
+    record[5] = addr;
+    record[6] = reg;
+    record[7] = result;
+    record[8] = len;
+    if(len > 0) memcpy(&record[UNITEMP_TRACE_HEADER_SIZE], data, len);
+    trace_buffer_len += UNITEMP_TRACE_HEADER_SIZE + len;
+    furi_mutex_release(trace_mutex);
+}
+
+/**
+ * @brief Get the replay cursor of the device, a new cursor starts at the oldest record
+ * @param bus Bus of the device
+ * @param addr Device address
+ * @return Pointer to the cursor, NULL if there are too many devices
+ */
+static UnitempTraceCursor* unitemp_trace_get_cursor(UnitempTraceBus bus, uint8_t addr) {
+    for(uint8_t i = 0; i < trace_cursors_count; i++) {
+        if(trace_cursors[i].bus == bus && trace_cursors[i].addr == addr) return &trace_cursors[i];
+    }
+    if(trace_cursors_count == UNITEMP_TRACE_CURSORS_MAX) return NULL;
+
+    UnitempTraceCursor* cursor = &trace_cursors[trace_cursors_count++];
+    cursor->bus = bus;
+    cursor->addr = addr;
+    cursor->segment = 0;
+    cursor->offset = sizeof(trace_magic);
+    return cursor;
+}
+
+/**
+ * @brief Read the next record of the device, the newest segment follows the previous one
+ * 
+ * The records of the other devices are skipped. The data of the record is read to the buffer.
+ * @param cursor Pointer to the cursor of the device, moved past the record
+ * @param header Pointer to an array of UNITEMP_TRACE_HEADER_SIZE bytes
+ * @return True if the record is read, false at the end of the trace
+ */
+static bool unitemp_trace_read_record(UnitempTraceCursor* cursor, uint8_t* header) {
+    while(cursor->segment < 2) {
+        File* file = trace_segments[cursor->segment];
+        if(file != NULL && storage_file_seek(file, cursor->offset, true)) {
+            while(storage_file_read(file, header, UNITEMP_TRACE_HEADER_SIZE) ==
+                  UNITEMP_TRACE_HEADER_SIZE) {
+                uint8_t len = header[8];
+                cursor->offset += UNITEMP_TRACE_HEADER_SIZE + len;
+                if((header[4] >> 4) == cursor->bus && header[5] == cursor->addr) {
+                    return storage_file_read(file, trace_buffer, len) == len;
+                }
+                if(!storage_file_seek(file, cursor->offset, true)) break;
+            }
+        }
+        cursor->segment++;
+        cursor->offset = sizeof(trace_magic);
+        if(cursor->segment == 2) {
+            FURI_LOG_W(
+                APP_NAME,
+                "End of the bus trace (bus %d, address 0x%02X)",
+                cursor->bus,
+                cursor->addr);
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Take the next transaction of the device from the trace
+ * @param bus Bus of the transaction
+ * @param dir Transaction direction
+ * @param addr Device address
+ * @param reg Register address
+ * @param sent Sent data to compare with the record, NULL for the read transactions
+ * @param received Array for the recorded data, NULL for the send transactions
+ * @param len Number of bytes
+ * @param result Pointer to the result, set to the recorded one
+ * @return True if the trace is being replayed
+ */
+static bool unitemp_trace_replay(
+    UnitempTraceBus bus,
+    UnitempTraceDir dir,
+    uint8_t addr,
+    uint8_t reg,
+    const uint8_t* sent,
+    uint8_t* received,
+    uint8_t len,
+    uint8_t* result) {
+    if(trace_state != UnitempTraceModeReplay) return false;
+
+    furi_mutex_acquire(trace_mutex, FuriWaitForever);
+    trace_replayed++;
+    UnitempTraceCursor* cursor = unitemp_trace_get_cursor(bus, addr);
+    if(cursor == NULL && !trace_mismatch_logged) {
+        trace_mismatch_logged = true;
+        FURI_LOG_E(APP_NAME, "Too many devices in the bus trace");
+    }
+    //The end of the trace of the device is reported once
+    bool end = cursor == NULL || cursor->segment == 2;
+    uint8_t header[UNITEMP_TRACE_HEADER_SIZE];
+    bool match = !end && unitemp_trace_read_record(cursor, header);
+    if(match) {
+        bool same_header = (header[4] & 0x0F) == dir && header[6] == reg && header[8] == len;
+        match = same_header;
+        if(match && sent != NULL && len > 0) match = memcmp(trace_buffer, sent, len) == 0;
+
+        //The first mismatch is reported in detail
+        if(!match && !trace_mismatch_logged) {
+            trace_mismatch_logged = true;
+            FURI_LOG_W(
+                APP_NAME,
+                "Bus trace mismatch at transaction %lu (bus %d, address 0x%02X): "
+                "recorded dir %d reg 0x%02X len %d, polled dir %d reg 0x%02X len %d%s",
+                trace_replayed,
+                bus,
+                addr,
+                header[4] & 0x0F,
+                header[6],
+                header[8],
+                dir,
+                reg,
+                len,
+                same_header ? ", the data differs" : "");
+        } else if(!match) {
+            FURI_LOG_W(
+                APP_NAME,
+                "Bus trace mismatch at transaction %lu (bus %d, address 0x%02X)",
+                trace_replayed,
+                bus,
+                addr);
+        }
+    }
+    if(match) {
+        if(received != NULL && len > 0) memcpy(received, trace_buffer, len);
+        *result = header[7];
+    } else {
+        trace_mismatches++;
+    }
+    furi_mutex_release(trace_mutex);
+    return true;
+}
+
+bool unitemp_trace_replay_write(
+    UnitempTraceBus bus,
+    UnitempTraceDir dir,
+    uint8_t addr,
+    uint8_t reg,
+    const uint8_t* data,
+    uint8_t len,
+    uint8_t* result) {
+    return unitemp_trace_replay(bus, dir, addr, reg, data, NULL, len, result);
+}
+
+bool unitemp_trace_replay_read(
+    UnitempTraceBus bus,
+    uint8_t addr,
+    uint8_t reg,
+    uint8_t* data,
+    uint8_t len,
+    uint8_t* result) {
+    return unitemp_trace_replay(bus, UnitempTraceDirRead, addr, reg, NULL, data, len, result);
+}
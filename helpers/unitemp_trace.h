@@ -0,0 +1,187 @@
+/*
+    Unitemp - Universal temperature reader
+    Copyright (C) 2022-2026  Victor Nikitchuk (https://github.com/quen0n)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#ifndef UNITEMP_TRACE_H_
+#define UNITEMP_TRACE_H_
+
+#include <furi.h>
+#include <storage/storage.h>
+
+/*
+    Trace file format (all numbers are little-endian):
+    "UTR" and the format version, then the records one after another.
+    Record: tick (4 bytes), bus << 4 | direction, address, register, result,
+    data length, then the data bytes.
+    The ring consists of two segments: UNITEMP_TRACE_FILENAME is written, when it
+    is full it becomes UNITEMP_TRACE_OLD_FILENAME and the older segment is deleted.
+*/
+
+//Newest segment of the trace
+#define UNITEMP_TRACE_FILENAME     "bus.trace"
+//Previous segment of the trace
+#define UNITEMP_TRACE_OLD_FILENAME "bus.trace.old"
+//Trace format version
+#define UNITEMP_TRACE_VERSION      1
+//Maximum segment size, bytes
+#define UNITEMP_TRACE_SEGMENT_SIZE (64 * 1024UL)
+//Size of the buffer that keeps the records until they are written to the SD card
+#define UNITEMP_TRACE_BUFFER_SIZE  1024
+//Size of the record header, bytes
+#define UNITEMP_TRACE_HEADER_SIZE  9
+//Maximum number of devices replayed from the trace
+#define UNITEMP_TRACE_CURSORS_MAX  32
+
+//Trace mode
+typedef enum {
+    UnitempTraceModeOff,
+    UnitempTraceModeRecord,
+    UnitempTraceModeReplay,
+
+    UnitempTraceModesCount
+} UnitempTraceMode;
+
+//Traced bus
+typedef enum {
+    UnitempTraceBusI2C,
+    UnitempTraceBusSPI,
+    UnitempTraceBusOneWire,
+    UnitempTraceBusSingleWire,
+} UnitempTraceBus;
+
+//Transaction direction
+typedef enum {
+    //Data is sent to the device
+    UnitempTraceDirWrite,
+    //Data is received from the device
+    UnitempTraceDirRead,
+    //Check of the device presence (I2C address acknowledge)
+    UnitempTraceDirProbe,
+    //Bus reset (1-Wire presence pulse)
+    UnitempTraceDirReset,
+} UnitempTraceDir;
+
+/**
+ * @brief Set the trace mode. The mode takes effect at the next start of the trace
+ * @param mode Trace mode
+ */
+void unitemp_trace_set_mode(UnitempTraceMode mode);
+
+/**
+ * @brief Get the trace mode
+ * @return Trace mode
+ */
+UnitempTraceMode unitemp_trace_get_mode(void);
+
+/**
+ * @brief Delete the recorded trace
+ * @param storage Pointer to the storage
+ */
+void unitemp_trace_clear(Storage* storage);
+
+/**
+ * @brief Start recording or replaying the trace according to the mode
+ *
+ * The recording is appended to the existing trace. The replay starts from
+ * the oldest record of every device.
+ * @param storage Pointer to the storage
+ * @return True if the trace is started or the trace mode is off
+ */
+bool unitemp_trace_start(Storage* storage);
+
+/**
+ * @brief Stop the trace. The buffered records are written to the SD card
+ */
+void unitemp_trace_stop(void);
+
+/**
+ * @brief Write the buffered records to the SD card
+ *
+ * The transactions are buffered in RAM and the card is written between the poll
+ * cycles. The buffer is written at once only when it is full.
+ */
+void unitemp_trace_flush(void);
+
+/**
+ * @brief Check if the transactions are taken from the trace instead of the buses
+ * @return True if the trace is being replayed
+ */
+bool unitemp_trace_is_replaying(void);
+
+/**
+ * @brief Record the transaction if the trace is being recorded
+ * @param bus Bus of the transaction
+ * @param dir Transaction direction
+ * @param addr Device address (I2C address, CS or data pin number)
+ * @param reg Register address for memory transactions, 0 otherwise
+ * @param data Transferred data
+ * @param len Number of bytes
+ * @param result Transaction result
+ */
+void unitemp_trace_record(
+    UnitempTraceBus bus,
+    UnitempTraceDir dir,
+    uint8_t addr,
+    uint8_t reg,
+    const uint8_t* data,
+    uint8_t len,
+    uint8_t result);
+
+/**
+ * @brief Take the result of the sending transaction from the trace
+ *
+ * The transaction is compared with the next record of the same device (bus and
+ * address), so the devices may be polled in another order than when recording.
+ * A transaction that differs from the record or goes beyond the end of the trace
+ * is counted as a mismatch, its result is left unchanged.
+ * @param bus Bus of the transaction
+ * @param dir Transaction direction (write, probe or reset)
+ * @param addr Device address (I2C address, CS or data pin number)
+ * @param reg Register address for memory transactions, 0 otherwise
+ * @param data Sent data
+ * @param len Number of bytes
+ * @param result Pointer to the result, set to the recorded one
+ * @return True if the transaction is replayed and must not be sent to the bus
+ */
+bool unitemp_trace_replay_write(
+    UnitempTraceBus bus,
+    UnitempTraceDir dir,
+    uint8_t addr,
+    uint8_t reg,
+    const uint8_t* data,
+    uint8_t len,
+    uint8_t* result);
+
+/**
+ * @brief Take the received data of the transaction from the trace
+ *
+ * A mismatched transaction leaves the data and the result unchanged.
+ * @param bus Bus of the transaction
+ * @param addr Device address (I2C address, CS or data pin number)
+ * @param reg Register address for memory transactions, 0 otherwise
+ * @param data Pointer to an array where the recorded data will be copied
+ * @param len Number of bytes
+ * @param result Pointer to the result, set to the recorded one
+ * @return True if the transaction is replayed and must not be sent to the bus
+ */
+bool unitemp_trace_replay_read(
+    UnitempTraceBus bus,
+    uint8_t addr,
+    uint8_t reg,
+    uint8_t* data,
+    uint8_t len,
+    uint8_t* result);
+#endif
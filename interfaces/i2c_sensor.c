@@ -17,6 +17,7 @@
 */
 #include "i2c_sensor.h"
 #include "../helpers/unitemp_gpio.h"
+#include "../helpers/unitemp_trace.h"
 
 const SensorConnectionInterface unitemp_i2c = {
     .name = "I2C",
@@ -24,38 +25,232 @@ const SensorConnectionInterface unitemp_i2c = {
     .mem_releaser = unitemp_i2c_sensor_free,
     .updater = unitemp_i2c_sensor_update};
 
+//Number of sensors on the main bus
 static uint8_t sensors_count = 0;
 
+//Multiplexers on the main bus
+static UnitempI2CMuxState main_bus_mux = {0};
+
 void unitemp_i2c_acquire(const FuriHalI2cBusHandle* handle) {
     furi_hal_i2c_acquire(handle);
     LL_GPIO_SetPinPull(gpio_ext_pc1.port, gpio_ext_pc1.pin, LL_GPIO_PULL_UP);
     LL_GPIO_SetPinPull(gpio_ext_pc0.port, gpio_ext_pc0.pin, LL_GPIO_PULL_UP);
 }
 
+/* ------------------- Transactions on the bus of the sensor ------------------- */
+
+static bool unitemp_i2c_bus_tx(
+    I2CSensor* i2c_sensor,
+    uint8_t addr,
+    const uint8_t* data,
+    uint8_t len,
+    uint32_t timeout) {
+    uint8_t result = false;
+    if(unitemp_trace_replay_write(
+           UnitempTraceBusI2C, UnitempTraceDirWrite, addr, 0, data, len, &result)) {
+        return result;
+    }
+    if(i2c_sensor->soft_bus != NULL) {
+        result = unitemp_i2c_soft_tx(i2c_sensor->soft_bus, addr, data, len, timeout);
+    } else {
+        result = furi_hal_i2c_tx(i2c_sensor->i2c_handle, addr, data, len, timeout);
+    }
+    unitemp_trace_record(UnitempTraceBusI2C, UnitempTraceDirWrite, addr, 0, data, len, result);
+    return result;
+}
+
+static bool unitemp_i2c_bus_rx(
+    I2CSensor* i2c_sensor,
+    uint8_t addr,
+    uint8_t* data,
+    uint8_t len,
+    uint32_t timeout) {
+    uint8_t result = false;
+    if(unitemp_trace_replay_read(UnitempTraceBusI2C, addr, 0, data, len, &result)) {
+        return result;
+    }
+    if(i2c_sensor->soft_bus != NULL) {
+        result = unitemp_i2c_soft_rx(i2c_sensor->soft_bus, addr, data, len, timeout);
+    } else {
+        result = furi_hal_i2c_rx(i2c_sensor->i2c_handle, addr, data, len, timeout);
+    }
+    unitemp_trace_record(UnitempTraceBusI2C, UnitempTraceDirRead, addr, 0, data, len, result);
+    return result;
+}
+
+static bool unitemp_i2c_bus_read_mem(
+    I2CSensor* i2c_sensor,
+    uint8_t addr,
+    uint8_t reg,
+    uint8_t* data,
+    uint8_t len,
+    uint32_t timeout) {
+    uint8_t result = false;
+    if(unitemp_trace_replay_read(UnitempTraceBusI2C, addr, reg, data, len, &result)) {
+        return result;
+    }
+    if(i2c_sensor->soft_bus != NULL) {
+        result = unitemp_i2c_soft_read_mem(i2c_sensor->soft_bus, addr, reg, data, len, timeout);
+    } else {
+        result = furi_hal_i2c_read_mem(i2c_sensor->i2c_handle, addr, reg, data, len, timeout);
+    }
+    unitemp_trace_record(UnitempTraceBusI2C, UnitempTraceDirRead, addr, reg, data, len, result);
+    return result;
+}
+
+static bool unitemp_i2c_bus_write_mem(
+    I2CSensor* i2c_sensor,
+    uint8_t addr,
+    uint8_t reg,
+    const uint8_t* data,
+    uint8_t len,
+    uint32_t timeout) {
+    uint8_t result = false;
+    if(unitemp_trace_replay_write(
+           UnitempTraceBusI2C, UnitempTraceDirWrite, addr, reg, data, len, &result)) {
+        return result;
+    }
+    if(i2c_sensor->soft_bus != NULL) {
+        result = unitemp_i2c_soft_write_mem(i2c_sensor->soft_bus, addr, reg, data, len, timeout);
+    } else {
+        result = furi_hal_i2c_write_mem(i2c_sensor->i2c_handle, addr, reg, data, len, timeout);
+    }
+    unitemp_trace_record(UnitempTraceBusI2C, UnitempTraceDirWrite, addr, reg, data, len, result);
+    return result;
+}
+
+static bool
+    unitemp_i2c_bus_is_device_ready(I2CSensor* i2c_sensor, uint8_t addr, uint32_t timeout) {
+    uint8_t result = false;
+    if(unitemp_trace_replay_write(
+           UnitempTraceBusI2C, UnitempTraceDirProbe, addr, 0, NULL, 0, &result)) {
+        return result;
+    }
+    if(i2c_sensor->soft_bus != NULL) {
+        result = unitemp_i2c_soft_is_device_ready(i2c_sensor->soft_bus, addr, timeout);
+    } else {
+        result = furi_hal_i2c_is_device_ready(i2c_sensor->i2c_handle, addr, timeout);
+    }
+    unitemp_trace_record(UnitempTraceBusI2C, UnitempTraceDirProbe, addr, 0, NULL, 0, result);
+    return result;
+}
+
+/**
+ * @brief Connect the bus segment of the sensor. The bus must be acquired
+ * 
+ * @param i2c_sensor Pointer to sensor instance
+ * @param mux_addr Multiplexer address, 0 for the direct connection
+ * @param mux_channel Multiplexer channel
+ * @return True if the segment is connected
+ */
+static bool
+    unitemp_i2c_mux_select(I2CSensor* i2c_sensor, uint8_t mux_addr, uint8_t mux_channel) {
+    UnitempI2CMuxState* mux = i2c_sensor->soft_bus != NULL ? &i2c_sensor->soft_bus->mux :
+                                                             &main_bus_mux;
+    //The segment is already connected
+    if(mux_addr == mux->adress && (mux_addr == 0 || mux_channel == mux->channel)) {
+        return true;
+    }
+    //Closing the channel of another multiplexer
+    if(mux->adress != 0 && mux->adress != mux_addr) {
+        uint8_t mask = 0;
+        unitemp_i2c_bus_tx(
+            i2c_sensor, mux->adress, &mask, 1, unitemp_i2c_get_timeout(i2c_sensor, 1));
+        mux->adress = 0;
+    }
+    if(mux_addr == 0) return true;
+
+    uint8_t mask = 1 << mux_channel;
+    if(!unitemp_i2c_bus_tx(
+           i2c_sensor, mux_addr, &mask, 1, unitemp_i2c_get_timeout(i2c_sensor, 1))) {
+        UNITEMP_DEBUG("Multiplexer 0x%02X is not responding", mux_addr >> 1);
+        mux->adress = 0;
+        return false;
+    }
+    mux->adress = mux_addr;
+    mux->channel = mux_channel;
+    return true;
+}
+
+/**
+ * @brief Lock the bus and connect the segment of the sensor
+ * 
+ * @param i2c_sensor Pointer to sensor instance
+ * @return True if the sensor segment is available. The bus stays locked anyway
+ */
+static bool unitemp_i2c_begin(I2CSensor* i2c_sensor) {
+    if(i2c_sensor->soft_bus != NULL) {
+        unitemp_i2c_soft_acquire(i2c_sensor->soft_bus);
+    } else {
+        unitemp_i2c_acquire(i2c_sensor->i2c_handle);
+    }
+    return unitemp_i2c_mux_select(
+        i2c_sensor, i2c_sensor->mux_i2c_adress, i2c_sensor->mux_channel);
+}
+
+/**
+ * @brief Unlock the bus of the sensor
+ * 
+ * @param i2c_sensor Pointer to sensor instance
+ */
+static void unitemp_i2c_end(I2CSensor* i2c_sensor) {
+    if(i2c_sensor->soft_bus != NULL) {
+        unitemp_i2c_soft_release(i2c_sensor->soft_bus);
+    } else {
+        furi_hal_i2c_release(i2c_sensor->i2c_handle);
+    }
+}
+
+uint16_t unitemp_i2c_get_segment(I2CSensor* i2c_sensor) {
+    if(i2c_sensor->mux_i2c_adress == 0) return 0;
+    return ((uint16_t)i2c_sensor->mux_i2c_adress << 8) | (i2c_sensor->mux_channel + 1);
+}
+
+uint32_t unitemp_i2c_get_timeout(I2CSensor* i2c_sensor, uint8_t len) {
+    //Address byte + data bytes, 9 clocks per byte (8 bits + ACK)
+    uint32_t bus_time_us = ((uint32_t)len + 1) * 9UL * 1000000UL / UNITEMP_I2C_BUS_CLOCK_HZ;
+    return (bus_time_us + 999UL) / 1000UL + UNITEMP_I2C_TIMEOUT_MARGIN_MS +
+           i2c_sensor->clock_stretch_ms;
+}
+
 bool unitemp_i2c_is_device_ready(I2CSensor* i2c_sensor) {
-    unitemp_i2c_acquire(i2c_sensor->i2c_handle);
-    bool status =
-        furi_hal_i2c_is_device_ready(i2c_sensor->i2c_handle, i2c_sensor->current_i2c_adress, 10);
-    furi_hal_i2c_release(i2c_sensor->i2c_handle);
+    bool status = false;
+    if(unitemp_i2c_begin(i2c_sensor)) {
+        status = unitemp_i2c_bus_is_device_ready(
+            i2c_sensor, i2c_sensor->current_i2c_adress, unitemp_i2c_get_timeout(i2c_sensor, 0));
+    }
+    unitemp_i2c_end(i2c_sensor);
     return status;
 }
 
 uint8_t unitemp_i2c_read_reg(I2CSensor* i2c_sensor, uint8_t reg) {
-    //Bus lock
-    unitemp_i2c_acquire(i2c_sensor->i2c_handle);
     uint8_t buff[1] = {0};
-
-    furi_hal_i2c_read_mem(
-        i2c_sensor->i2c_handle, i2c_sensor->current_i2c_adress, reg, buff, 1, 10);
-    furi_hal_i2c_release(i2c_sensor->i2c_handle);
+    //Bus lock
+    if(unitemp_i2c_begin(i2c_sensor)) {
+        //Register byte + repeated start address + data byte
+        unitemp_i2c_bus_read_mem(
+            i2c_sensor,
+            i2c_sensor->current_i2c_adress,
+            reg,
+            buff,
+            1,
+            unitemp_i2c_get_timeout(i2c_sensor, 3));
+    }
+    unitemp_i2c_end(i2c_sensor);
     return buff[0];
 }
 
 bool unitemp_i2c_read_array(I2CSensor* i2c_sensor, uint8_t len, uint8_t* data) {
-    unitemp_i2c_acquire(i2c_sensor->i2c_handle);
-    bool status =
-        furi_hal_i2c_rx(i2c_sensor->i2c_handle, i2c_sensor->current_i2c_adress, data, len, 10);
-    furi_hal_i2c_release(i2c_sensor->i2c_handle);
+    bool status = false;
+    if(unitemp_i2c_begin(i2c_sensor)) {
+        status = unitemp_i2c_bus_rx(
+            i2c_sensor,
+            i2c_sensor->current_i2c_adress,
+            data,
+            len,
+            unitemp_i2c_get_timeout(i2c_sensor, len));
+    }
+    unitemp_i2c_end(i2c_sensor);
     return status;
 }
 
@@ -64,28 +259,48 @@ bool unitemp_i2c_read_reg_array(
     uint8_t startReg,
     uint8_t len,
     uint8_t* data) {
-    unitemp_i2c_acquire(i2c_sensor->i2c_handle);
-    bool status = furi_hal_i2c_read_mem(
-        i2c_sensor->i2c_handle, i2c_sensor->current_i2c_adress, startReg, data, len, 10);
-    furi_hal_i2c_release(i2c_sensor->i2c_handle);
+    bool status = false;
+    if(unitemp_i2c_begin(i2c_sensor)) {
+        status = unitemp_i2c_bus_read_mem(
+            i2c_sensor,
+            i2c_sensor->current_i2c_adress,
+            startReg,
+            data,
+            len,
+            unitemp_i2c_get_timeout(i2c_sensor, len + 2));
+    }
+    unitemp_i2c_end(i2c_sensor);
     return status;
 }
 
 bool unitemp_i2c_write_reg(I2CSensor* i2c_sensor, uint8_t reg, uint8_t value) {
-    //Bus lock
-    unitemp_i2c_acquire(i2c_sensor->i2c_handle);
     uint8_t buff[1] = {value};
-    bool status = furi_hal_i2c_write_mem(
-        i2c_sensor->i2c_handle, i2c_sensor->current_i2c_adress, reg, buff, 1, 10);
-    furi_hal_i2c_release(i2c_sensor->i2c_handle);
+    bool status = false;
+    //Bus lock
+    if(unitemp_i2c_begin(i2c_sensor)) {
+        status = unitemp_i2c_bus_write_mem(
+            i2c_sensor,
+            i2c_sensor->current_i2c_adress,
+            reg,
+            buff,
+            1,
+            unitemp_i2c_get_timeout(i2c_sensor, 2));
+    }
+    unitemp_i2c_end(i2c_sensor);
     return status;
 }
 
 bool unitemp_i2c_write_array(I2CSensor* i2c_sensor, uint8_t len, uint8_t* data) {
-    unitemp_i2c_acquire(i2c_sensor->i2c_handle);
-    bool status =
-        furi_hal_i2c_tx(i2c_sensor->i2c_handle, i2c_sensor->current_i2c_adress, data, len, 10);
-    furi_hal_i2c_release(i2c_sensor->i2c_handle);
+    bool status = false;
+    if(unitemp_i2c_begin(i2c_sensor)) {
+        status = unitemp_i2c_bus_tx(
+            i2c_sensor,
+            i2c_sensor->current_i2c_adress,
+            data,
+            len,
+            unitemp_i2c_get_timeout(i2c_sensor, len));
+    }
+    unitemp_i2c_end(i2c_sensor);
     return status;
 }
 
@@ -94,14 +309,103 @@ bool unitemp_i2c_write_reg_array(
     uint8_t startReg,
     uint8_t len,
     uint8_t* data) {
+    bool status = false;
     //Bus lock
-    unitemp_i2c_acquire(i2c_sensor->i2c_handle);
-    bool status = furi_hal_i2c_write_mem(
-        i2c_sensor->i2c_handle, i2c_sensor->current_i2c_adress, startReg, data, len, 10);
-    furi_hal_i2c_release(i2c_sensor->i2c_handle);
+    if(unitemp_i2c_begin(i2c_sensor)) {
+        status = unitemp_i2c_bus_write_mem(
+            i2c_sensor,
+            i2c_sensor->current_i2c_adress,
+            startReg,
+            data,
+            len,
+            unitemp_i2c_get_timeout(i2c_sensor, len + 1));
+    }
+    unitemp_i2c_end(i2c_sensor);
     return status;
 }
 
+bool unitemp_i2c_main_bus_is_aviable(void) {
+    const SensorConnectionInterface* sda =
+        unitemp_gpio_get_interface(unitemp_gpio_get_from_int(UNITEMP_I2C_MAIN_SDA_PIN));
+    const SensorConnectionInterface* scl =
+        unitemp_gpio_get_interface(unitemp_gpio_get_from_int(UNITEMP_I2C_MAIN_SCL_PIN));
+    return (sda == NULL || sda == &unitemp_i2c) && (scl == NULL || scl == &unitemp_i2c);
+}
+
+bool unitemp_i2c_get_free_pins(const SensorGpioPin** sda_pin, const SensorGpioPin** scl_pin) {
+    if(unitemp_i2c_main_bus_is_aviable()) {
+        *sda_pin = unitemp_gpio_get_from_int(UNITEMP_I2C_MAIN_SDA_PIN);
+        *scl_pin = unitemp_gpio_get_from_int(UNITEMP_I2C_MAIN_SCL_PIN);
+        return true;
+    }
+    //The first two free pins for the software bus
+    *sda_pin = NULL;
+    *scl_pin = NULL;
+    for(uint8_t i = 0; i < unitemp_gpio_get_count(); i++) {
+        const SensorGpioPin* gpio = unitemp_gpio_get_from_index(i);
+        if(!unitemp_i2c_soft_pin_is_aviable(gpio)) continue;
+        if(*sda_pin == NULL) {
+            *sda_pin = gpio;
+        } else {
+            *scl_pin = gpio;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool unitemp_i2c_soft_pin_is_aviable(const SensorGpioPin* gpio) {
+    return gpio != NULL && gpio->num != UNITEMP_I2C_MAIN_SDA_PIN &&
+           gpio->num != UNITEMP_I2C_MAIN_SCL_PIN && unitemp_gpio_get_interface(gpio) == NULL;
+}
+
+const SensorGpioPin* unitemp_i2c_get_sda_pin(I2CSensor* i2c_sensor) {
+    if(i2c_sensor->soft_bus != NULL) return i2c_sensor->soft_bus->sda_pin;
+    return unitemp_gpio_get_from_int(UNITEMP_I2C_MAIN_SDA_PIN);
+}
+
+const SensorGpioPin* unitemp_i2c_get_scl_pin(I2CSensor* i2c_sensor) {
+    if(i2c_sensor->soft_bus != NULL) return i2c_sensor->soft_bus->scl_pin;
+    return unitemp_gpio_get_from_int(UNITEMP_I2C_MAIN_SCL_PIN);
+}
+
+//Disconnect the sensor from its bus and free the pins if it was the last sensor
+static void unitemp_i2c_sensor_release_bus(I2CSensor* i2c_sensor) {
+    if(i2c_sensor->soft_bus != NULL) {
+        unitemp_i2c_soft_bus_free(i2c_sensor->soft_bus);
+        i2c_sensor->soft_bus = NULL;
+    } else if(i2c_sensor->i2c_handle != NULL) {
+        if(--sensors_count == 0) {
+            unitemp_gpio_unlock(unitemp_gpio_get_from_int(UNITEMP_I2C_MAIN_SDA_PIN));
+            unitemp_gpio_unlock(unitemp_gpio_get_from_int(UNITEMP_I2C_MAIN_SCL_PIN));
+        }
+    }
+    i2c_sensor->i2c_handle = NULL;
+}
+
+bool unitemp_i2c_sensor_set_bus(
+    I2CSensor* i2c_sensor,
+    const SensorGpioPin* sda_pin,
+    const SensorGpioPin* scl_pin) {
+    unitemp_i2c_sensor_release_bus(i2c_sensor);
+
+    bool main_bus = sda_pin == NULL || scl_pin == NULL ||
+                    (sda_pin->num == UNITEMP_I2C_MAIN_SDA_PIN &&
+                     scl_pin->num == UNITEMP_I2C_MAIN_SCL_PIN);
+    //Software bus on any other pins
+    if(!main_bus) {
+        i2c_sensor->soft_bus = unitemp_i2c_soft_bus_alloc(sda_pin, scl_pin);
+        if(i2c_sensor->soft_bus != NULL) return true;
+    }
+
+    //Main bus. Blocking GPIO ports
+    i2c_sensor->i2c_handle = &furi_hal_i2c_handle_external;
+    sensors_count++;
+    unitemp_gpio_lock(unitemp_gpio_get_from_int(UNITEMP_I2C_MAIN_SDA_PIN), &unitemp_i2c, NULL);
+    unitemp_gpio_lock(unitemp_gpio_get_from_int(UNITEMP_I2C_MAIN_SCL_PIN), &unitemp_i2c, NULL);
+    return main_bus;
+}
+
 bool unitemp_i2c_sensor_alloc(Sensor* sensor, char* args) {
     bool status = false;
     I2CSensor* instance = malloc(sizeof(I2CSensor));
@@ -109,13 +413,20 @@ bool unitemp_i2c_sensor_alloc(Sensor* sensor, char* args) {
         FURI_LOG_E(APP_NAME, "Sensor %s instance allocation error", sensor->name);
         return false;
     }
-    instance->i2c_handle = &furi_hal_i2c_handle_external;
+    instance->i2c_handle = NULL;
+    instance->soft_bus = NULL;
+    //Devices without clock stretching by default, the model allocator can override it
+    instance->clock_stretch_ms = 0;
+    //Models with a split measurement set the pipeline functions in their allocator
+    instance->pipeline_start = NULL;
+    instance->pipeline_read = NULL;
     sensor->instance = instance;
 
     //Specifying the functions of initialization, deinitialization and data update, as well as the address on the I2C bus
     status = sensor->model->allocator(sensor, args);
-    int i2c_addr;
-    sscanf(args, "%X", &i2c_addr);
+    int i2c_addr = 0, mux_addr = 0, mux_channel = 0, sda_num = 0, scl_num = 0;
+    int fields =
+        sscanf(args, "%X %X %d %d %d", &i2c_addr, &mux_addr, &mux_channel, &sda_num, &scl_num);
 
     //Setting the I2C bus address
     if(i2c_addr >= instance->min_i2c_adress && i2c_addr <= instance->max_i2c_adress) {
@@ -123,22 +434,35 @@ bool unitemp_i2c_sensor_alloc(Sensor* sensor, char* args) {
     } else {
         instance->current_i2c_adress = instance->min_i2c_adress;
     }
+    //Setting the multiplexer channel
+    if(mux_addr >= UNITEMP_I2C_MUX_MIN_ADRESS && mux_addr <= UNITEMP_I2C_MUX_MAX_ADRESS &&
+       mux_channel >= 0 && mux_channel < UNITEMP_I2C_MUX_CHANNELS) {
+        instance->mux_i2c_adress = mux_addr;
+        instance->mux_channel = mux_channel;
+    } else {
+        instance->mux_i2c_adress = 0;
+        instance->mux_channel = 0;
+    }
 
-    //Blocking GPIO ports
-    sensors_count++;
-    unitemp_gpio_lock(unitemp_gpio_get_from_int(15), &unitemp_i2c);
-    unitemp_gpio_lock(unitemp_gpio_get_from_int(16), &unitemp_i2c);
+    //Bus pins. Sensors saved without pins are on the main bus
+    const SensorGpioPin* sda_pin = NULL;
+    const SensorGpioPin* scl_pin = NULL;
+    if(fields == 5) {
+        sda_pin = unitemp_gpio_get_from_int(sda_num);
+        scl_pin = unitemp_gpio_get_from_int(scl_num);
+    } else if(fields <= 0) {
+        //New sensor, the main bus is preferred
+        unitemp_i2c_get_free_pins(&sda_pin, &scl_pin);
+    }
+    unitemp_i2c_sensor_set_bus(instance, sda_pin, scl_pin);
 
     return status;
 }
 
 bool unitemp_i2c_sensor_free(Sensor* sensor) {
     bool status = sensor->model->mem_releaser(sensor);
+    unitemp_i2c_sensor_release_bus(sensor->instance);
     free(sensor->instance);
-    if(--sensors_count == 0) {
-        unitemp_gpio_unlock(unitemp_gpio_get_from_int(15));
-        unitemp_gpio_unlock(unitemp_gpio_get_from_int(16));
-    }
 
     return status;
 }
@@ -147,12 +471,70 @@ SensorStatus unitemp_i2c_sensor_update(Sensor* sensor) {
     return sensor->model->updater(sensor);
 }
 
-bool unitemp_i2c_addr_is_used(uint8_t addr) {
+bool unitemp_i2c_sensor_is_pipelined(Sensor* sensor) {
+    if(sensor->model->interface != &unitemp_i2c) return false;
+    I2CSensor* i2c_sensor = sensor->instance;
+    return i2c_sensor->pipeline_start != NULL && i2c_sensor->pipeline_read != NULL;
+}
+
+void unitemp_i2c_sensors_update_pipelined(
+    Sensor** sensors,
+    SensorStatus* statuses,
+    uint8_t count) {
+    //POLLING marks the sensors taking part in the current step
+    for(uint8_t i = 0; i < count; i++) {
+        statuses[i] = UT_SENSORSTATUS_POLLING;
+    }
+
+    for(uint8_t step = 0; step < UNITEMP_I2C_PIPELINE_STEPS_MAX; step++) {
+        bool started = false;
+        uint32_t ready_tick = furi_get_tick();
+
+        //Starting the conversions back to back
+        for(uint8_t i = 0; i < count; i++) {
+            if(statuses[i] != UT_SENSORSTATUS_POLLING) continue;
+            I2CSensor* i2c_sensor = sensors[i]->instance;
+            uint16_t conversion_time = i2c_sensor->pipeline_start(sensors[i], step);
+            if(conversion_time == 0) {
+                statuses[i] = UT_SENSORSTATUS_TIMEOUT;
+                continue;
+            }
+            //The conversion of each sensor ends relative to its own start.
+            //One more tick covers the part of the current tick that has already passed
+            uint32_t tick = furi_get_tick() + furi_ms_to_ticks(conversion_time) + 1;
+            if((int32_t)(tick - ready_tick) > 0) ready_tick = tick;
+            started = true;
+        }
+        if(!started) break;
+
+        //Waiting once for the longest conversion
+        int32_t wait = (int32_t)(ready_tick - furi_get_tick());
+        if(wait > 0) furi_delay_tick(wait);
+
+        //Reading the results in the same order
+        for(uint8_t i = 0; i < count; i++) {
+            if(statuses[i] != UT_SENSORSTATUS_POLLING) continue;
+            statuses[i] = ((I2CSensor*)sensors[i]->instance)->pipeline_read(sensors[i], step);
+        }
+    }
+}
+
+bool unitemp_i2c_addr_is_used(I2CSensor* i2c_sensor, uint8_t addr) {
     for(uint8_t i = 0; i < unitemp_sensors_get_count(); i++) {
         Sensor* sensor = unitemp_sensors_get(i);
         if(sensor->model->interface == &unitemp_i2c) {
-            I2CSensor* i2c_sensor = sensor->instance;
-            if(i2c_sensor->current_i2c_adress == addr) return true;
+            I2CSensor* other = sensor->instance;
+            if(other == i2c_sensor) continue;
+            //Sensors on different buses do not interfere
+            if(other->soft_bus != i2c_sensor->soft_bus) continue;
+            //Multiplexers are visible from any segment
+            if(other->mux_i2c_adress == addr) return true;
+            if(other->current_i2c_adress != addr) continue;
+            //Directly connected devices are visible from any segment
+            if(other->mux_i2c_adress == 0 || i2c_sensor->mux_i2c_adress == 0) return true;
+            if(other->mux_i2c_adress == i2c_sensor->mux_i2c_adress &&
+               other->mux_channel == i2c_sensor->mux_channel)
+                return true;
         }
     }
 
@@ -174,11 +556,14 @@ uint8_t unitemp_i2c_bus_scan_next(I2CSensor* i2c_sensor) {
             last_addr = i2c_sensor->min_i2c_adress;
         }
 
-        unitemp_i2c_acquire(i2c_sensor->i2c_handle);
-        bool result = furi_hal_i2c_is_device_ready(i2c_sensor->i2c_handle, last_addr, 10);
-        furi_hal_i2c_release(i2c_sensor->i2c_handle);
+        bool result = false;
+        if(unitemp_i2c_begin(i2c_sensor)) {
+            result = unitemp_i2c_bus_is_device_ready(
+                i2c_sensor, last_addr, unitemp_i2c_get_timeout(i2c_sensor, 0));
+        }
+        unitemp_i2c_end(i2c_sensor);
 
-        bool is_used = unitemp_i2c_addr_is_used(last_addr);
+        bool is_used = unitemp_i2c_addr_is_used(i2c_sensor, last_addr);
         UNITEMP_DEBUG(
             "Address 0x%02X is %s and %s used for other sensor",
             (last_addr >> 1),
@@ -20,21 +20,65 @@
 
 #include "../unitemp.h"
 #include "../sensors.h"
+#include "i2c_soft.h"
 
 #include <furi_hal_i2c.h>
 
+//External I2C bus clock (Hz)
+#define UNITEMP_I2C_BUS_CLOCK_HZ 100000UL
+//Fixed margin added to the timeout of every I2C transaction (ms)
+#define UNITEMP_I2C_TIMEOUT_MARGIN_MS 1UL
+
+//Pins of the main (hardware) bus
+#define UNITEMP_I2C_MAIN_SDA_PIN 15
+#define UNITEMP_I2C_MAIN_SCL_PIN 16
+
+//TCA9548A/PCA9548 multiplexer addresses (8 bits) and number of channels
+#define UNITEMP_I2C_MUX_MIN_ADRESS (0x70 << 1)
+#define UNITEMP_I2C_MUX_MAX_ADRESS (0x77 << 1)
+#define UNITEMP_I2C_MUX_CHANNELS   8
+#define UNITEMP_I2C_MUX_COUNT      ((UNITEMP_I2C_MUX_MAX_ADRESS - UNITEMP_I2C_MUX_MIN_ADRESS) / 2 + 1)
+//Maximum number of measurement steps in a pipelined poll
+#define UNITEMP_I2C_PIPELINE_STEPS_MAX 4
+
+/**
+ * @brief Start of a pipelined measurement step
+ * @param sensor Pointer to sensor
+ * @param step Step number, starting from 0
+ * @return Conversion time (ms), 0 if the sensor did not respond
+ */
+typedef uint16_t(UnitempI2CPipelineStart)(Sensor* sensor, uint8_t step);
+/**
+ * @brief Reading the result of a pipelined measurement step
+ * @param sensor Pointer to sensor
+ * @param step Step number, starting from 0
+ * @return Sensor poll status, UT_SENSORSTATUS_POLLING if the next step must be started
+ */
+typedef SensorStatus(UnitempI2CPipelineRead)(Sensor* sensor, uint8_t step);
+
 //I2C sensor structure
 typedef struct I2CSensor {
-    //Pointer to I2C interface
+    //Pointer to I2C interface, NULL if the sensor is on a software bus
     const FuriHalI2cBusHandle* i2c_handle;
+    //Software bus, NULL if the sensor is on the main bus
+    UnitempI2CSoftBus* soft_bus;
     //Minimum device address on the I2C bus
     uint8_t min_i2c_adress;
     //Maximum device address on the I2C bus
     uint8_t max_i2c_adress;
     //Current device address on the I2C bus
     uint8_t current_i2c_adress;
+    //Maximum time the device can hold SCL low (clock stretching), ms
+    uint16_t clock_stretch_ms;
+    //Address of the I2C multiplexer the sensor is connected to, 0 if connected directly
+    uint8_t mux_i2c_adress;
+    //Multiplexer channel (0-7)
+    uint8_t mux_channel;
     //Pointer to its own sensor instance
     void* sensor_instance;
+    //Split measurement for the pipelined poll, NULL if the model does not support it
+    UnitempI2CPipelineStart* pipeline_start;
+    UnitempI2CPipelineRead* pipeline_read;
 } I2CSensor;
 
 extern const SensorConnectionInterface
@@ -47,6 +91,30 @@ extern const SensorConnectionInterface
  */
 void unitemp_i2c_acquire(const FuriHalI2cBusHandle* handle);
 
+/**
+ * @brief Get the timeout of an I2C transaction
+ * 
+ * The timeout is derived from the number of bytes on the wire and the bus clock,
+ * plus a fixed margin and the clock stretching time of the device.
+ * 
+ * @param i2c_sensor Pointer to sensor instance
+ * @param len Number of data bytes in the transaction (address byte is added automatically)
+ * @return Timeout in milliseconds
+ */
+uint32_t unitemp_i2c_get_timeout(I2CSensor* i2c_sensor, uint8_t len);
+
+/**
+ * @brief Get the bus segment of the sensor
+ * 
+ * Sensors connected directly to the bus are in segment 0. Sensors behind
+ * a multiplexer are in the segment defined by the multiplexer address and channel.
+ * Polling sensors grouped by segment minimizes multiplexer channel switching.
+ * 
+ * @param i2c_sensor Pointer to sensor instance
+ * @return Segment number
+ */
+uint16_t unitemp_i2c_get_segment(I2CSensor* i2c_sensor);
+
 /**
  * @brief Check the presence of a sensor on the tire
  * 
@@ -75,6 +143,29 @@ bool unitemp_i2c_sensor_free(Sensor* sensor);
  * @return Update status
  */
 SensorStatus unitemp_i2c_sensor_update(Sensor* sensor);
+
+/**
+ * @brief Check that the sensor supports the pipelined poll
+ * @param sensor Pointer to sensor
+ * @return True if the sensor is on the I2C bus and its model splits the measurement
+ */
+bool unitemp_i2c_sensor_is_pipelined(Sensor* sensor);
+
+/**
+ * @brief Pipelined poll of several I2C sensors
+ * 
+ * The conversions of all sensors are started back to back, then the longest
+ * conversion time is waited once and the results are read in order.
+ * The cycle time approaches the maximum conversion time instead of the sum.
+ * 
+ * @param sensors Array of sensors supporting the pipelined poll
+ * @param statuses Array where the poll statuses will be written
+ * @param count Number of sensors
+ */
+void unitemp_i2c_sensors_update_pipelined(
+    Sensor** sensors,
+    SensorStatus* statuses,
+    uint8_t count);
 /**
  * @brief Read the value of the reg register
  * @param i2c_sensor Pointer to sensor instance
@@ -156,9 +247,65 @@ uint8_t unitemp_i2c_bus_scan_next(I2CSensor* i2c_sensor);
 /**
  * @brief Checks if the specified I2C address is already in use by a sensor.
  * 
+ * Only sensors on the same bus are checked. Sensors behind different multiplexer channels
+ * can share the same address. Sensors connected directly to the bus and multiplexers themselves
+ * are visible from any channel.
+ * 
+ * @param i2c_sensor Sensor whose bus and multiplexer channel are checked.
  * @param addr The I2C address to check (8-bit format).
  * 
- * @return true if the address is already used by an active sensor, false otherwise.
+ * @return true if the address is already used by another sensor, false otherwise.
+ */
+bool unitemp_i2c_addr_is_used(I2CSensor* i2c_sensor, uint8_t addr);
+
+/**
+ * @brief Connect the sensor to the bus on the specified pins
+ * 
+ * Pins 15 and 16 are the main (hardware) bus, any other pair creates or joins a software bus.
+ * The previous bus of the sensor is released.
+ * 
+ * @param i2c_sensor Pointer to sensor instance
+ * @param sda_pin Data line, NULL for the main bus
+ * @param scl_pin Clock line, NULL for the main bus
+ * @return True if the sensor is connected to the requested bus, false if it fell back to the main bus
+ */
+bool unitemp_i2c_sensor_set_bus(
+    I2CSensor* i2c_sensor,
+    const SensorGpioPin* sda_pin,
+    const SensorGpioPin* scl_pin);
+
+/**
+ * @brief Get the data line of the sensor bus
+ * @param i2c_sensor Pointer to sensor instance
+ * @return Pointer to pin
+ */
+const SensorGpioPin* unitemp_i2c_get_sda_pin(I2CSensor* i2c_sensor);
+
+/**
+ * @brief Get the clock line of the sensor bus
+ * @param i2c_sensor Pointer to sensor instance
+ * @return Pointer to pin
+ */
+const SensorGpioPin* unitemp_i2c_get_scl_pin(I2CSensor* i2c_sensor);
+
+/**
+ * @brief Check that pins 15 and 16 are free or already used by the main I2C bus
+ * @return True if a sensor can be added to the main bus
+ */
+bool unitemp_i2c_main_bus_is_aviable(void);
+
+/**
+ * @brief Check that the pin can be used for a new software bus
+ * @param gpio Pointer to pin
+ * @return True if the pin is free and does not belong to the main bus
+ */
+bool unitemp_i2c_soft_pin_is_aviable(const SensorGpioPin* gpio);
+
+/**
+ * @brief Get the pins for a new I2C sensor: the main bus if possible, otherwise the first two free pins
+ * @param sda_pin Pointer where the data line will be written
+ * @param scl_pin Pointer where the clock line will be written
+ * @return True if there are pins for the sensor
  */
-bool unitemp_i2c_addr_is_used(uint8_t addr);
+bool unitemp_i2c_get_free_pins(const SensorGpioPin** sda_pin, const SensorGpioPin** scl_pin);
 #endif
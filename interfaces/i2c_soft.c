@@ -0,0 +1,306 @@
+/*
+    Unitemp - Universal temperature reader
+    Copyright (C) 2022-2026  Victor Nikitchuk (https://github.com/quen0n)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "i2c_soft.h"
+#include "i2c_sensor.h"
+
+//Created software buses
+static UnitempI2CSoftBus* soft_buses[UNITEMP_I2C_SOFT_BUSES_MAX] = {0};
+
+/* ----------------------------- Line control ----------------------------- */
+
+//Wait for half of the SCL period counted from the previous bus edge.
+//Time spent in the code between the edges is included in the period
+static inline void unitemp_i2c_soft_delay(UnitempI2CSoftBus* bus) {
+    while(DWT->CYCCNT - bus->edge_time < bus->half_period) {
+    }
+    bus->edge_time = DWT->CYCCNT;
+}
+
+static inline void unitemp_i2c_soft_sda(UnitempI2CSoftBus* bus, bool level) {
+    furi_hal_gpio_write(bus->sda_pin->pin, level);
+}
+
+static inline bool unitemp_i2c_soft_sda_read(UnitempI2CSoftBus* bus) {
+    return furi_hal_gpio_read(bus->sda_pin->pin);
+}
+
+static inline void unitemp_i2c_soft_scl_low(UnitempI2CSoftBus* bus) {
+    furi_hal_gpio_write(bus->scl_pin->pin, false);
+}
+
+//Release SCL and wait while the device holds it low (clock stretching)
+static bool unitemp_i2c_soft_scl_high(UnitempI2CSoftBus* bus) {
+    furi_hal_gpio_write(bus->scl_pin->pin, true);
+    while(!furi_hal_gpio_read(bus->scl_pin->pin)) {
+        if(furi_hal_cortex_timer_is_expired(bus->deadline)) {
+            UNITEMP_DEBUG("SCL is held low on the bus %s", bus->scl_pin->name);
+            return false;
+        }
+    }
+    //The high level is counted from the actual rising edge
+    bus->edge_time = DWT->CYCCNT;
+    return true;
+}
+
+/* ----------------------------- Bus conditions ----------------------------- */
+
+//Start or repeated start condition
+static bool unitemp_i2c_soft_start(UnitempI2CSoftBus* bus) {
+    unitemp_i2c_soft_sda(bus, true);
+    unitemp_i2c_soft_delay(bus);
+    if(!unitemp_i2c_soft_scl_high(bus)) return false;
+    unitemp_i2c_soft_delay(bus);
+    //SDA is held by another device
+    if(!unitemp_i2c_soft_sda_read(bus)) return false;
+    unitemp_i2c_soft_sda(bus, false);
+    unitemp_i2c_soft_delay(bus);
+    unitemp_i2c_soft_scl_low(bus);
+    return true;
+}
+
+static void unitemp_i2c_soft_stop(UnitempI2CSoftBus* bus) {
+    unitemp_i2c_soft_scl_low(bus);
+    unitemp_i2c_soft_sda(bus, false);
+    unitemp_i2c_soft_delay(bus);
+    //The lines are released even if the device keeps stretching the clock
+    unitemp_i2c_soft_scl_high(bus);
+    unitemp_i2c_soft_delay(bus);
+    unitemp_i2c_soft_sda(bus, true);
+    unitemp_i2c_soft_delay(bus);
+}
+
+static bool unitemp_i2c_soft_write_byte(UnitempI2CSoftBus* bus, uint8_t byte) {
+    for(uint8_t mask = 0x80; mask != 0; mask >>= 1) {
+        unitemp_i2c_soft_sda(bus, byte & mask);
+        unitemp_i2c_soft_delay(bus);
+        if(!unitemp_i2c_soft_scl_high(bus)) return false;
+        unitemp_i2c_soft_delay(bus);
+        unitemp_i2c_soft_scl_low(bus);
+    }
+    //Acknowledge from the device
+    unitemp_i2c_soft_sda(bus, true);
+    unitemp_i2c_soft_delay(bus);
+    if(!unitemp_i2c_soft_scl_high(bus)) return false;
+    unitemp_i2c_soft_delay(bus);
+    bool ack = !unitemp_i2c_soft_sda_read(bus);
+    unitemp_i2c_soft_scl_low(bus);
+    return ack;
+}
+
+static bool unitemp_i2c_soft_read_byte(UnitempI2CSoftBus* bus, uint8_t* byte, bool ack) {
+    uint8_t value = 0;
+    unitemp_i2c_soft_sda(bus, true);
+    for(uint8_t i = 0; i < 8; i++) {
+        unitemp_i2c_soft_delay(bus);
+        if(!unitemp_i2c_soft_scl_high(bus)) return false;
+        unitemp_i2c_soft_delay(bus);
+        value = (value << 1) | unitemp_i2c_soft_sda_read(bus);
+        unitemp_i2c_soft_scl_low(bus);
+    }
+    //Acknowledge (NACK after the last byte)
+    unitemp_i2c_soft_sda(bus, !ack);
+    unitemp_i2c_soft_delay(bus);
+    if(!unitemp_i2c_soft_scl_high(bus)) return false;
+    unitemp_i2c_soft_delay(bus);
+    unitemp_i2c_soft_scl_low(bus);
+    *byte = value;
+    return true;
+}
+
+//Prepare the timing of a new transaction
+static void unitemp_i2c_soft_begin(UnitempI2CSoftBus* bus, uint32_t timeout) {
+    bus->deadline = furi_hal_cortex_timer_get(timeout * 1000);
+    bus->edge_time = DWT->CYCCNT;
+}
+
+static bool
+    unitemp_i2c_soft_write_bytes(UnitempI2CSoftBus* bus, const uint8_t* data, uint8_t len) {
+    for(uint8_t i = 0; i < len; i++) {
+        if(!unitemp_i2c_soft_write_byte(bus, data[i])) return false;
+    }
+    return true;
+}
+
+static bool unitemp_i2c_soft_read_bytes(UnitempI2CSoftBus* bus, uint8_t* data, uint8_t len) {
+    for(uint8_t i = 0; i < len; i++) {
+        if(!unitemp_i2c_soft_read_byte(bus, &data[i], i < len - 1)) return false;
+    }
+    return true;
+}
+
+//Release a device that was interrupted in the middle of a transfer and holds SDA low
+static void unitemp_i2c_soft_recovery(UnitempI2CSoftBus* bus) {
+    unitemp_i2c_soft_begin(bus, UNITEMP_I2C_TIMEOUT_MARGIN_MS);
+    for(uint8_t i = 0; i < 9 && !unitemp_i2c_soft_sda_read(bus); i++) {
+        unitemp_i2c_soft_scl_low(bus);
+        unitemp_i2c_soft_delay(bus);
+        unitemp_i2c_soft_scl_high(bus);
+        unitemp_i2c_soft_delay(bus);
+    }
+    unitemp_i2c_soft_stop(bus);
+}
+
+/* ----------------------------- Bus management ----------------------------- */
+
+static void unitemp_i2c_soft_pin_init(const SensorGpioPin* gpio) {
+    furi_hal_gpio_write(gpio->pin, true);
+    furi_hal_gpio_init(gpio->pin, GpioModeOutputOpenDrain, GpioPullUp, GpioSpeedVeryHigh);
+    unitemp_gpio_lock(gpio, &unitemp_i2c, NULL);
+}
+
+static void unitemp_i2c_soft_pin_deinit(const SensorGpioPin* gpio) {
+    furi_hal_gpio_init(gpio->pin, GpioModeAnalog, GpioPullNo, GpioSpeedLow);
+    unitemp_gpio_unlock(gpio);
+}
+
+UnitempI2CSoftBus*
+    unitemp_i2c_soft_bus_alloc(const SensorGpioPin* sda_pin, const SensorGpioPin* scl_pin) {
+    if(sda_pin == NULL || scl_pin == NULL || sda_pin == scl_pin) return NULL;
+
+    //Checking for bus presence on these pins
+    for(uint8_t i = 0; i < UNITEMP_I2C_SOFT_BUSES_MAX; i++) {
+        if(soft_buses[i] != NULL && soft_buses[i]->sda_pin == sda_pin &&
+           soft_buses[i]->scl_pin == scl_pin) {
+            soft_buses[i]->references++;
+            return soft_buses[i];
+        }
+    }
+
+    uint8_t index = 0;
+    while(index < UNITEMP_I2C_SOFT_BUSES_MAX && soft_buses[index] != NULL) index++;
+    if(index == UNITEMP_I2C_SOFT_BUSES_MAX) {
+        FURI_LOG_E(APP_NAME, "Too many software I2C buses");
+        return NULL;
+    }
+
+    UnitempI2CSoftBus* bus = malloc(sizeof(UnitempI2CSoftBus));
+    if(bus == NULL) {
+        FURI_LOG_E(APP_NAME, "Software I2C bus allocation error");
+        return NULL;
+    }
+    bus->sda_pin = sda_pin;
+    bus->scl_pin = scl_pin;
+    bus->references = 1;
+    bus->mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    bus->half_period =
+        furi_hal_cortex_instructions_per_microsecond() * 1000000UL / UNITEMP_I2C_SOFT_CLOCK_HZ / 2;
+    bus->mux.adress = 0;
+    bus->mux.channel = 0;
+    soft_buses[index] = bus;
+
+    unitemp_i2c_soft_pin_init(sda_pin);
+    unitemp_i2c_soft_pin_init(scl_pin);
+    unitemp_i2c_soft_recovery(bus);
+
+    UNITEMP_DEBUG("Software I2C bus (SDA %d, SCL %d) allocated", sda_pin->num, scl_pin->num);
+    return bus;
+}
+
+void unitemp_i2c_soft_bus_free(UnitempI2CSoftBus* bus) {
+    if(bus == NULL) return;
+    if(--bus->references > 0) return;
+
+    for(uint8_t i = 0; i < UNITEMP_I2C_SOFT_BUSES_MAX; i++) {
+        if(soft_buses[i] == bus) soft_buses[i] = NULL;
+    }
+    unitemp_i2c_soft_pin_deinit(bus->sda_pin);
+    unitemp_i2c_soft_pin_deinit(bus->scl_pin);
+    furi_mutex_free(bus->mutex);
+    UNITEMP_DEBUG(
+        "Software I2C bus (SDA %d, SCL %d) freed", bus->sda_pin->num, bus->scl_pin->num);
+    free(bus);
+}
+
+UnitempI2CSoftBus* unitemp_i2c_soft_bus_get(uint8_t index) {
+    if(index >= UNITEMP_I2C_SOFT_BUSES_MAX) return NULL;
+    return soft_buses[index];
+}
+
+void unitemp_i2c_soft_acquire(UnitempI2CSoftBus* bus) {
+    furi_check(furi_mutex_acquire(bus->mutex, FuriWaitForever) == FuriStatusOk);
+}
+
+void unitemp_i2c_soft_release(UnitempI2CSoftBus* bus) {
+    furi_check(furi_mutex_release(bus->mutex) == FuriStatusOk);
+}
+
+/* ----------------------------- Transactions ----------------------------- */
+
+bool unitemp_i2c_soft_is_device_ready(UnitempI2CSoftBus* bus, uint8_t addr, uint32_t timeout) {
+    unitemp_i2c_soft_begin(bus, timeout);
+    bool status = unitemp_i2c_soft_start(bus) && unitemp_i2c_soft_write_byte(bus, addr & 0xFE);
+    unitemp_i2c_soft_stop(bus);
+    return status;
+}
+
+bool unitemp_i2c_soft_tx(
+    UnitempI2CSoftBus* bus,
+    uint8_t addr,
+    const uint8_t* data,
+    uint8_t len,
+    uint32_t timeout) {
+    unitemp_i2c_soft_begin(bus, timeout);
+    bool status = unitemp_i2c_soft_start(bus) && unitemp_i2c_soft_write_byte(bus, addr & 0xFE) &&
+                  unitemp_i2c_soft_write_bytes(bus, data, len);
+    unitemp_i2c_soft_stop(bus);
+    return status;
+}
+
+bool unitemp_i2c_soft_rx(
+    UnitempI2CSoftBus* bus,
+    uint8_t addr,
+    uint8_t* data,
+    uint8_t len,
+    uint32_t timeout) {
+    unitemp_i2c_soft_begin(bus, timeout);
+    bool status = unitemp_i2c_soft_start(bus) && unitemp_i2c_soft_write_byte(bus, addr | 0x01) &&
+                  unitemp_i2c_soft_read_bytes(bus, data, len);
+    unitemp_i2c_soft_stop(bus);
+    return status;
+}
+
+bool unitemp_i2c_soft_read_mem(
+    UnitempI2CSoftBus* bus,
+    uint8_t addr,
+    uint8_t reg,
+    uint8_t* data,
+    uint8_t len,
+    uint32_t timeout) {
+    unitemp_i2c_soft_begin(bus, timeout);
+    bool status = unitemp_i2c_soft_start(bus) && unitemp_i2c_soft_write_byte(bus, addr & 0xFE) &&
+                  unitemp_i2c_soft_write_byte(bus, reg) && unitemp_i2c_soft_start(bus) &&
+                  unitemp_i2c_soft_write_byte(bus, addr | 0x01) &&
+                  unitemp_i2c_soft_read_bytes(bus, data, len);
+    unitemp_i2c_soft_stop(bus);
+    return status;
+}
+
+bool unitemp_i2c_soft_write_mem(
+    UnitempI2CSoftBus* bus,
+    uint8_t addr,
+    uint8_t reg,
+    const uint8_t* data,
+    uint8_t len,
+    uint32_t timeout) {
+    unitemp_i2c_soft_begin(bus, timeout);
+    bool status = unitemp_i2c_soft_start(bus) && unitemp_i2c_soft_write_byte(bus, addr & 0xFE) &&
+                  unitemp_i2c_soft_write_byte(bus, reg) &&
+                  unitemp_i2c_soft_write_bytes(bus, data, len);
+    unitemp_i2c_soft_stop(bus);
+    return status;
+}
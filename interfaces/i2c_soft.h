@@ -0,0 +1,169 @@
+/*
+    Unitemp - Universal temperature reader
+    Copyright (C) 2022-2026  Victor Nikitchuk (https://github.com/quen0n)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#ifndef UNITEMP_I2C_SOFT
+#define UNITEMP_I2C_SOFT
+
+#include "../unitemp.h"
+#include "../helpers/unitemp_gpio.h"
+
+//Software I2C bus clock (Hz)
+#define UNITEMP_I2C_SOFT_CLOCK_HZ 100000UL
+//Maximum number of software buses (two pins each)
+#define UNITEMP_I2C_SOFT_BUSES_MAX 5
+
+//State of the multiplexers on a bus
+typedef struct {
+    //Multiplexer with an open channel (0 - all channels are closed)
+    uint8_t adress;
+    //Open channel
+    uint8_t channel;
+} UnitempI2CMuxState;
+
+//Software (bit-banged) I2C bus instance
+typedef struct {
+    //Data line
+    const SensorGpioPin* sda_pin;
+    //Clock line
+    const SensorGpioPin* scl_pin;
+    //Number of sensors using the bus
+    uint8_t references;
+    //Bus lock
+    FuriMutex* mutex;
+    //Half of the SCL period, CPU cycles
+    uint32_t half_period;
+    //CPU cycle counter value at the last bus edge
+    uint32_t edge_time;
+    //End of the current transaction, limits the clock stretching wait
+    FuriHalCortexTimer deadline;
+    //Multiplexers on this bus
+    UnitempI2CMuxState mux;
+} UnitempI2CSoftBus;
+
+/**
+ * @brief Get a software bus on the specified pins
+ * 
+ * The bus is shared by all sensors connected to the same pins.
+ * @param sda_pin Data line
+ * @param scl_pin Clock line
+ * @return Pointer to the bus, NULL if the bus cannot be created
+ */
+UnitempI2CSoftBus*
+    unitemp_i2c_soft_bus_alloc(const SensorGpioPin* sda_pin, const SensorGpioPin* scl_pin);
+
+/**
+ * @brief Release the software bus. The pins are freed when the last sensor leaves the bus
+ * @param bus Pointer to bus
+ */
+void unitemp_i2c_soft_bus_free(UnitempI2CSoftBus* bus);
+
+/**
+ * @brief Get an existing software bus by index
+ * @param index Bus index (from 0 to UNITEMP_I2C_SOFT_BUSES_MAX)
+ * @return Pointer to bus, NULL if there is no bus with this index
+ */
+UnitempI2CSoftBus* unitemp_i2c_soft_bus_get(uint8_t index);
+
+/**
+ * @brief Lock the software bus
+ * @param bus Pointer to bus
+ */
+void unitemp_i2c_soft_acquire(UnitempI2CSoftBus* bus);
+
+/**
+ * @brief Unlock the software bus
+ * @param bus Pointer to bus
+ */
+void unitemp_i2c_soft_release(UnitempI2CSoftBus* bus);
+
+/**
+ * @brief Check the presence of a device on the software bus
+ * @param bus Pointer to bus
+ * @param addr Device address (8 bits)
+ * @param timeout Transaction timeout, ms
+ * @return True if the device has responded
+ */
+bool unitemp_i2c_soft_is_device_ready(UnitempI2CSoftBus* bus, uint8_t addr, uint32_t timeout);
+
+/**
+ * @brief Write data to the device on the software bus
+ * @param bus Pointer to bus
+ * @param addr Device address (8 bits)
+ * @param data Pointer to the data to write
+ * @param len Number of bytes
+ * @param timeout Transaction timeout, ms
+ * @return True if the device acknowledged all bytes
+ */
+bool unitemp_i2c_soft_tx(
+    UnitempI2CSoftBus* bus,
+    uint8_t addr,
+    const uint8_t* data,
+    uint8_t len,
+    uint32_t timeout);
+
+/**
+ * @brief Read data from the device on the software bus
+ * @param bus Pointer to bus
+ * @param addr Device address (8 bits)
+ * @param data Pointer to an array where the data will be read
+ * @param len Number of bytes
+ * @param timeout Transaction timeout, ms
+ * @return True if the device returned data
+ */
+bool unitemp_i2c_soft_rx(
+    UnitempI2CSoftBus* bus,
+    uint8_t addr,
+    uint8_t* data,
+    uint8_t len,
+    uint32_t timeout);
+
+/**
+ * @brief Read device memory starting from the register (write register, repeated start, read)
+ * @param bus Pointer to bus
+ * @param addr Device address (8 bits)
+ * @param reg Register address
+ * @param data Pointer to an array where the data will be read
+ * @param len Number of bytes
+ * @param timeout Transaction timeout, ms
+ * @return True if the device returned data
+ */
+bool unitemp_i2c_soft_read_mem(
+    UnitempI2CSoftBus* bus,
+    uint8_t addr,
+    uint8_t reg,
+    uint8_t* data,
+    uint8_t len,
+    uint32_t timeout);
+
+/**
+ * @brief Write device memory starting from the register
+ * @param bus Pointer to bus
+ * @param addr Device address (8 bits)
+ * @param reg Register address
+ * @param data Pointer to the data to write
+ * @param len Number of bytes
+ * @param timeout Transaction timeout, ms
+ * @return True if the device acknowledged all bytes
+ */
+bool unitemp_i2c_soft_write_mem(
+    UnitempI2CSoftBus* bus,
+    uint8_t addr,
+    uint8_t reg,
+    const uint8_t* data,
+    uint8_t len,
+    uint32_t timeout);
+#endif
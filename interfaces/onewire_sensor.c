@@ -19,6 +19,8 @@
 
 #include "onewire_sensor.h"
 #include "./sensors/DS18x2x.h"
+#include "../helpers/unitemp_crc.h"
+#include "../helpers/unitemp_trace.h"
 #include <furi.h>
 #include <furi_hal.h>
 
@@ -28,36 +30,61 @@ const SensorConnectionInterface unitemp_1w = {
     .mem_releaser = unitemp_ds18x2x_sensor_free,
     .updater = unitemp_ds18x2x_sensor_update};
 
+//Allocated buses
+static UnitempOneWireBus* onewire_buses[UNITEMP_ONEWIRE_BUSES_MAX] = {0};
+
 UnitempOneWireBus* unitemp_onewire_bus_alloc(const SensorGpioPin* gpio_pin) {
     if(gpio_pin == NULL) {
         return NULL;
     }
 
     //Checking for bus presence on this port
-    for(uint8_t i = 0; i < unitemp_sensors_get_count(); i++) {
-        if(unitemp_sensors_get(i)->model->interface == &unitemp_1w &&
-           ((OneWireSensor*)unitemp_sensors_get(i)->instance)->bus->bus_pin == gpio_pin) {
+    int8_t free_slot = -1;
+    for(uint8_t i = 0; i < UNITEMP_ONEWIRE_BUSES_MAX; i++) {
+        if(onewire_buses[i] == NULL) {
+            if(free_slot < 0) free_slot = i;
+        } else if(onewire_buses[i]->bus_pin == gpio_pin) {
             //If there is already a bus on this port, then return a pointer to the bus
-            return ((OneWireSensor*)unitemp_sensors_get(i)->instance)->bus;
+            onewire_buses[i]->references++;
+            return onewire_buses[i];
         }
     }
+    if(free_slot < 0) {
+        FURI_LOG_E(APP_NAME, "Too many one wire buses");
+        return NULL;
+    }
 
     UnitempOneWireBus* bus = malloc(sizeof(UnitempOneWireBus));
     bus->bus_pin = gpio_pin;
     bus->host = onewire_host_alloc(gpio_pin->pin);
     bus->devices_count = 0;
+    //Until the check, the devices are considered parasite-powered
+    bus->power_mode = PWR_PASSIVE;
+    bus->overdrive = false;
+    bus->references = 1;
+    bus->roms_count = 0;
+    bus->scan_cursor = 0;
+    bus->sensors_count = 0;
+    bus->cycle_state = UnitempOneWireCycleIdle;
+    bus->read_cursor = 0;
+    bus->refresh_cursor = 0;
+    unitemp_onewire_bus_enum_init(bus);
+    onewire_buses[free_slot] = bus;
     UNITEMP_DEBUG("one wire bus (port %d) allocated", gpio_pin->num);
 
     return bus;
 }
 
 void unitemp_onewire_bus_free(UnitempOneWireBus* unitemp_one_wire_bus) {
-    if(unitemp_one_wire_bus != NULL) {
-        if(unitemp_one_wire_bus->devices_count == 0) {
-            if(unitemp_one_wire_bus->host != NULL) onewire_host_free(unitemp_one_wire_bus->host);
-            free(unitemp_one_wire_bus);
-        }
+    if(unitemp_one_wire_bus == NULL) return;
+    if(unitemp_one_wire_bus->references > 0) unitemp_one_wire_bus->references--;
+    if(unitemp_one_wire_bus->references > 0) return;
+
+    for(uint8_t i = 0; i < UNITEMP_ONEWIRE_BUSES_MAX; i++) {
+        if(onewire_buses[i] == unitemp_one_wire_bus) onewire_buses[i] = NULL;
     }
+    if(unitemp_one_wire_bus->host != NULL) onewire_host_free(unitemp_one_wire_bus->host);
+    free(unitemp_one_wire_bus);
 }
 
 bool unitemp_onewire_bus_init(UnitempOneWireBus* bus) {
@@ -67,7 +94,7 @@ bool unitemp_onewire_bus_init(UnitempOneWireBus* bus) {
     //Output if the bus has already been initialized
     if(bus->devices_count > 1) return true;
 
-    unitemp_gpio_lock(bus->bus_pin, &unitemp_1w);
+    unitemp_gpio_lock(bus->bus_pin, &unitemp_1w, NULL);
 
     onewire_host_start(bus->host);
 
@@ -81,6 +108,8 @@ bool unitemp_onewire_bus_deinit(UnitempOneWireBus* bus) {
     bus->devices_count--;
     UNITEMP_DEBUG("Device removed from bus %s. Total: %d", bus->bus_pin->name, bus->devices_count);
     if(bus->devices_count == 0) {
+        //The conversion in progress is abandoned
+        bus->cycle_state = UnitempOneWireCycleIdle;
         unitemp_gpio_unlock(bus->bus_pin);
         onewire_host_stop(bus->host);
         return true;
@@ -89,8 +118,69 @@ bool unitemp_onewire_bus_deinit(UnitempOneWireBus* bus) {
     }
 }
 
+void unitemp_onewire_buses_update(void) {
+    bool reading;
+    do {
+        reading = false;
+        for(uint8_t i = 0; i < UNITEMP_ONEWIRE_BUSES_MAX; i++) {
+            UnitempOneWireBus* bus = onewire_buses[i];
+            //Idle buses are started by their sensors
+            if(bus == NULL || bus->devices_count == 0) continue;
+            if(bus->cycle_state == UnitempOneWireCycleIdle) continue;
+            unitemp_ds18x2x_bus_update(bus);
+            if(bus->cycle_state == UnitempOneWireCycleReading) reading = true;
+        }
+    } while(reading);
+}
+
+uint32_t unitemp_onewire_buses_get_delay(void) {
+    uint32_t delay = UINT32_MAX;
+    for(uint8_t i = 0; i < UNITEMP_ONEWIRE_BUSES_MAX; i++) {
+        UnitempOneWireBus* bus = onewire_buses[i];
+        if(bus == NULL || bus->devices_count == 0) continue;
+        if(bus->cycle_state == UnitempOneWireCycleIdle) continue;
+        uint32_t left = unitemp_ds18x2x_bus_get_delay(bus);
+        if(left < delay) delay = left;
+    }
+    return delay;
+}
+
+//Overdrive speed of the capable devices
+static bool onewire_overdrive = false;
+
+void unitemp_onewire_set_overdrive(bool enabled) {
+    onewire_overdrive = enabled;
+}
+
+bool unitemp_onewire_get_overdrive(void) {
+    return onewire_overdrive;
+}
+
+bool unitemp_onewire_family_has_overdrive(uint8_t family_code) {
+    return family_code == FC_DS28EA00;
+}
+
 bool unitemp_onewire_bus_start(UnitempOneWireBus* bus) {
-    return onewire_host_reset(bus->host);
+    const uint8_t pin = bus->bus_pin->num;
+    //The standard speed reset also returns all devices to the standard speed
+    if(bus->overdrive) {
+        onewire_host_set_overdrive(bus->host, false);
+        bus->overdrive = false;
+    }
+    //The reset aborts the conversion in progress, the bus cycle starts a new one.
+    //Otherwise the read slot reports it as finished and the old scratchpads are published
+    if(bus->cycle_state == UnitempOneWireCycleConverting) {
+        if(bus->power_mode == PWR_PASSIVE) unitemp_onewire_bus_strong_mode(bus, false);
+        bus->cycle_state = UnitempOneWireCycleIdle;
+    }
+    uint8_t result = false;
+    if(unitemp_trace_replay_write(
+           UnitempTraceBusOneWire, UnitempTraceDirReset, pin, 0, NULL, 0, &result)) {
+        return result;
+    }
+    result = onewire_host_reset(bus->host);
+    unitemp_trace_record(UnitempTraceBusOneWire, UnitempTraceDirReset, pin, 0, NULL, 0, result);
+    return result;
 }
 
 void unitemp_onewire_bus_select_device(UnitempOneWireBus* bus, uint8_t* device_id) {
@@ -98,16 +188,82 @@ void unitemp_onewire_bus_select_device(UnitempOneWireBus* bus, uint8_t* device_i
     unitemp_onewire_bus_write_bytes(bus, device_id, 8);
 }
 
+void unitemp_onewire_sensor_select(OneWireSensor* ow_sensor) {
+    UnitempOneWireBus* bus = ow_sensor->bus;
+    if(!onewire_overdrive || !ow_sensor->overdrive) {
+        unitemp_onewire_bus_select_device(bus, ow_sensor->deviceID);
+        return;
+    }
+    //Overdrive match ROM: the command goes at standard speed, the address at overdrive speed
+    unitemp_onewire_bus_write(bus, 0x69);
+    onewire_host_set_overdrive(bus->host, true);
+    bus->overdrive = true;
+    unitemp_onewire_bus_write_bytes(bus, ow_sensor->deviceID, 8);
+}
+
+void unitemp_onewire_bus_skip_rom(UnitempOneWireBus* bus) {
+    bool overdrive = onewire_overdrive && bus->sensors_count > 0;
+    for(uint8_t i = 0; i < bus->sensors_count && overdrive; i++) {
+        overdrive = bus->sensors[i]->overdrive;
+    }
+    if(!overdrive) {
+        unitemp_onewire_bus_write(bus, 0xCC); //Skip ROM
+        return;
+    }
+    unitemp_onewire_bus_write(bus, 0x3C); //Overdrive skip ROM
+    onewire_host_set_overdrive(bus->host, true);
+    bus->overdrive = true;
+}
+
 void unitemp_onewire_bus_write(UnitempOneWireBus* bus, uint8_t data) {
-    onewire_host_write(bus->host, data);
+    unitemp_onewire_bus_write_bytes(bus, &data, 1);
 }
 
 void unitemp_onewire_bus_write_bytes(UnitempOneWireBus* bus, uint8_t* data, uint8_t len) {
+    const uint8_t pin = bus->bus_pin->num;
+    uint8_t result;
+    if(unitemp_trace_replay_write(
+           UnitempTraceBusOneWire, UnitempTraceDirWrite, pin, 0, data, len, &result)) {
+        return;
+    }
     onewire_host_write_bytes(bus->host, data, len);
+    unitemp_trace_record(UnitempTraceBusOneWire, UnitempTraceDirWrite, pin, 0, data, len, true);
 }
 
 void unitemp_onewire_bus_read_bytes(UnitempOneWireBus* bus, uint8_t* data, uint8_t len) {
+    const uint8_t pin = bus->bus_pin->num;
+    uint8_t result;
+    //The data missing from the trace reads as the idle line
+    memset(data, 0xFF, len);
+    if(unitemp_trace_replay_read(UnitempTraceBusOneWire, pin, 0, data, len, &result)) {
+        return;
+    }
     onewire_host_read_bytes(bus->host, data, len);
+    unitemp_trace_record(UnitempTraceBusOneWire, UnitempTraceDirRead, pin, 0, data, len, true);
+}
+
+bool unitemp_onewire_bus_read_bit(UnitempOneWireBus* bus) {
+    const uint8_t pin = bus->bus_pin->num;
+    uint8_t bit = 1;
+    uint8_t result;
+    if(unitemp_trace_replay_read(UnitempTraceBusOneWire, pin, 0, &bit, 1, &result)) {
+        return bit;
+    }
+    bit = onewire_host_read_bit(bus->host);
+    unitemp_trace_record(UnitempTraceBusOneWire, UnitempTraceDirRead, pin, 0, &bit, 1, true);
+    return bit;
+}
+
+void unitemp_onewire_bus_write_bit(UnitempOneWireBus* bus, bool value) {
+    const uint8_t pin = bus->bus_pin->num;
+    uint8_t bit = value;
+    uint8_t result;
+    if(unitemp_trace_replay_write(
+           UnitempTraceBusOneWire, UnitempTraceDirWrite, pin, 0, &bit, 1, &result)) {
+        return;
+    }
+    onewire_host_write_bit(bus->host, value);
+    unitemp_trace_record(UnitempTraceBusOneWire, UnitempTraceDirWrite, pin, 0, &bit, 1, true);
 }
 
 void unitemp_onewire_bus_strong_mode(UnitempOneWireBus* bus, bool state) {
@@ -122,20 +278,21 @@ void unitemp_onewire_bus_strong_mode(UnitempOneWireBus* bus, bool state) {
     }
 }
 
-static uint8_t onewire_CRC_update(uint8_t crc, uint8_t b) {
-    for(uint8_t p = 8; p; p--) {
-        crc = ((crc ^ b) & 1) ? (crc >> 1) ^ 0b10001100 : (crc >> 1);
-        b >>= 1;
-    }
-    return crc;
+bool unitemp_onewire_bus_read_power_mode(UnitempOneWireBus* bus) {
+    if(!unitemp_onewire_bus_start(bus)) return false;
+    unitemp_onewire_bus_write(bus, 0xCC); //Skip ROM
+    unitemp_onewire_bus_write(bus, 0xB4); //Read power supply
+    //Parasite-powered devices pull the line low in the read slot
+    bus->power_mode = unitemp_onewire_bus_read_bit(bus) ? PWR_ACTIVE : PWR_PASSIVE;
+    UNITEMP_DEBUG(
+        "Wire %s power mode: %s",
+        bus->bus_pin->name,
+        bus->power_mode == PWR_ACTIVE ? "external" : "parasite");
+    return true;
 }
 
 bool unitemp_onewire_CRC_check(uint8_t* data, uint8_t len) {
-    uint8_t crc = 0;
-    for(uint8_t i = 0; i < len; i++) {
-        crc = onewire_CRC_update(crc, data[i]);
-    }
-    return !crc;
+    return !unitemp_crc8_maxim(data, len);
 }
 
 bool unitemp_onewire_sensor_read_id(OneWireSensor* instance) {
@@ -147,6 +304,7 @@ bool unitemp_onewire_sensor_read_id(OneWireSensor* instance) {
         return false;
     }
     instance->family_code = instance->deviceID[0];
+    instance->overdrive = unitemp_onewire_family_has_overdrive(instance->family_code);
     return true;
 }
 
@@ -159,6 +317,8 @@ char* unitemp_onewire_sensor_get_fc_name(Sensor* sensor) {
         return "DS18S20";
     case FC_DS1822:
         return "DS1822";
+    case FC_DS28EA00:
+        return "DS28EA00";
     default:
         return "unknown";
     }
@@ -172,54 +332,93 @@ bool unitemp_onewire_id_compare(uint8_t* id1, uint8_t* id2) {
     return true;
 }
 
-bool unitemp_onewire_id_exist(uint8_t* id) {
-    if(id == NULL) return false;
-    for(uint8_t i = 0; i < unitemp_sensors_get_count(); i++) {
-        if(unitemp_sensors_get(i)->model->interface == &unitemp_1w) {
-            if(unitemp_onewire_id_compare(
-                   id, ((OneWireSensor*)(unitemp_sensors_get(i)->instance))->deviceID)) {
-                return true;
-            }
+void unitemp_onewire_bus_add_device(UnitempOneWireBus* bus, OneWireSensor* ow_sensor) {
+    if(bus == NULL || ow_sensor == NULL) return;
+    for(uint8_t i = 0; i < bus->sensors_count; i++) {
+        if(bus->sensors[i] == ow_sensor) return;
+    }
+    if(bus->sensors_count >= UNITEMP_ONEWIRE_DEVICES_MAX) {
+        FURI_LOG_E(APP_NAME, "Too many devices on wire %s", bus->bus_pin->name);
+        return;
+    }
+    bus->sensors[bus->sensors_count++] = ow_sensor;
+}
+
+void unitemp_onewire_bus_remove_device(UnitempOneWireBus* bus, OneWireSensor* ow_sensor) {
+    if(bus == NULL || ow_sensor == NULL) return;
+    for(uint8_t i = 0; i < bus->sensors_count; i++) {
+        if(bus->sensors[i] == ow_sensor) {
+            //The order of the set does not matter, the last sensor takes the freed place
+            bus->sensors[i] = bus->sensors[--bus->sensors_count];
+            return;
         }
     }
+}
+
+bool unitemp_onewire_bus_device_is_configured(UnitempOneWireBus* bus, uint8_t* id) {
+    if(bus == NULL || id == NULL) return false;
+    for(uint8_t i = 0; i < bus->sensors_count; i++) {
+        if(unitemp_onewire_id_compare(id, bus->sensors[i]->deviceID)) return true;
+    }
     return false;
 }
 
-bool unitemp_onewire_scan(OneWireSensor* ow_sensor) {
-    UNITEMP_DEBUG(
-        "Devices on bus %d: %d", ow_sensor->bus->bus_pin->num, ow_sensor->bus->devices_count);
+uint8_t unitemp_onewire_bus_enumerate(UnitempOneWireBus* bus) {
+    unitemp_onewire_bus_enum_init(bus);
+    bus->roms_count = 0;
+    bus->scan_cursor = 0;
+
+    //The number of search passes is limited in case of noise on the line
+    for(uint8_t pass = 0; pass < UNITEMP_ONEWIRE_DEVICES_MAX * 2; pass++) {
+        if(bus->roms_count >= UNITEMP_ONEWIRE_DEVICES_MAX) break;
+        uint8_t* id = unitemp_onewire_bus_enum_next(bus);
+        if(id == NULL) break;
+        //Corrupted addresses are skipped
+        if(!unitemp_onewire_CRC_check(id, 8)) continue;
+        bus->roms_overdrive[bus->roms_count] = unitemp_onewire_family_has_overdrive(id[0]);
+        memcpy(bus->roms[bus->roms_count++], id, 8);
+    }
+    UNITEMP_DEBUG("Devices found on wire %s: %d", bus->bus_pin->name, bus->roms_count);
+    return bus->roms_count;
+}
 
-    //One wire bus scan
-    unitemp_onewire_bus_init(ow_sensor->bus);
-    unitemp_onewire_bus_strong_mode(ow_sensor->bus, false);
+/**
+ * @brief Find the next device in the cached ROM table that is not configured on the bus
+ * @return Index in the ROM table, -1 if there is no such device
+ */
+static int8_t unitemp_onewire_bus_next_free_rom(UnitempOneWireBus* bus) {
+    for(uint8_t i = bus->scan_cursor; i < bus->roms_count; i++) {
+        if(!unitemp_onewire_bus_device_is_configured(bus, bus->roms[i])) return i;
+    }
+    return -1;
+}
 
-    uint8_t* id = NULL;
-    do {
-        do {
-            id = unitemp_onewire_bus_enum_next(ow_sensor->bus);
-        } while(unitemp_onewire_id_exist(id));
-
-        if(id == NULL) {
-            unitemp_onewire_bus_enum_init();
-            id = unitemp_onewire_bus_enum_next(ow_sensor->bus);
-            if(unitemp_onewire_id_exist(id)) {
-                do {
-                    id = unitemp_onewire_bus_enum_next(ow_sensor->bus);
-                } while(unitemp_onewire_id_exist(id) && id != NULL);
-            }
-            if(id == NULL) {
-                memset(ow_sensor->deviceID, 0, 8);
-                ow_sensor->family_code = 0;
-                break;
-            }
-        }
-    } while(0);
+bool unitemp_onewire_scan(OneWireSensor* ow_sensor) {
+    UnitempOneWireBus* bus = ow_sensor->bus;
+    UNITEMP_DEBUG("Devices on bus %d: %d", bus->bus_pin->num, bus->devices_count);
+
+    int8_t index = unitemp_onewire_bus_next_free_rom(bus);
+    if(index < 0) {
+        //All cached devices have been offered, enumerating the bus again
+        unitemp_onewire_bus_init(bus);
+        unitemp_onewire_bus_strong_mode(bus, false);
+        unitemp_onewire_bus_enumerate(bus);
+        unitemp_onewire_bus_deinit(bus);
+        index = unitemp_onewire_bus_next_free_rom(bus);
+    }
 
-    unitemp_onewire_bus_deinit(ow_sensor->bus);
-    if(id == NULL) return false;
+    if(index < 0) {
+        memset(ow_sensor->deviceID, 0, 8);
+        ow_sensor->family_code = 0;
+        ow_sensor->overdrive = false;
+        return false;
+    }
+    bus->scan_cursor = index + 1;
 
+    uint8_t* id = bus->roms[index];
     memcpy(ow_sensor->deviceID, id, 8);
     ow_sensor->family_code = id[0];
+    ow_sensor->overdrive = bus->roms_overdrive[index];
 
     UNITEMP_DEBUG(
         "Found sensor's ID: %02X%02X%02X%02X%02X%02X%02X%02X",
@@ -238,20 +437,32 @@ bool unitemp_onewire_scan(OneWireSensor* ow_sensor) {
     return false;
 }
 
-//Variables for storing the intermediate result of a bus scan
-//found eight-byte address
-static uint8_t onewire_enum[8] = {0};
-//the last zero bit where there was ambiguity (numbering from one)
-static uint8_t onewire_enum_fork_bit = 65;
-void unitemp_onewire_bus_enum_init(void) {
+void unitemp_onewire_bus_enum_init(UnitempOneWireBus* bus) {
     for(uint8_t p = 0; p < 8; p++) {
-        onewire_enum[p] = 0;
+        bus->enum_id[p] = 0;
     }
-    onewire_enum_fork_bit = 65; //to the right of the right
+    bus->enum_fork_bit = 65; //to the right of the right
 }
 
-uint8_t* unitemp_onewire_bus_enum_next(UnitempOneWireBus* bus) {
-    if(!onewire_enum_fork_bit) { //If there were no disagreements at the previous step
+//Alarm search mode of the bus measurement cycles
+static bool onewire_alarm_search = false;
+
+void unitemp_onewire_set_alarm_search(bool enabled) {
+    onewire_alarm_search = enabled;
+}
+
+bool unitemp_onewire_get_alarm_search(void) {
+    return onewire_alarm_search;
+}
+
+/**
+ * @brief Get the next address of the search started by the command
+ * @param bus Pointer to one wire bus
+ * @param command Search command: SEARCH ROM (0xF0) or ALARM SEARCH (0xEC)
+ * @return Pointer to the address, NULL if the search is completed
+ */
+static uint8_t* unitemp_onewire_bus_search_next(UnitempOneWireBus* bus, uint8_t command) {
+    if(!bus->enum_fork_bit) { //If there were no disagreements at the previous step
         UNITEMP_DEBUG("All devices on wire %s is found", bus->bus_pin->name);
         return 0; //then we just leave without returning anything
     }
@@ -260,26 +471,26 @@ uint8_t* unitemp_onewire_bus_enum_next(UnitempOneWireBus* bus) {
         return 0;
     }
     uint8_t bp = 8;
-    uint8_t* pprev = &onewire_enum[0];
+    uint8_t* pprev = &bus->enum_id[0];
     uint8_t prev = *pprev;
     uint8_t next = 0;
 
     uint8_t p = 1;
-    unitemp_onewire_bus_write(bus, 0xF0);
+    unitemp_onewire_bus_write(bus, command);
     uint8_t newfork = 0;
     for(;;) {
-        uint8_t not0 = onewire_host_read_bit(bus->host);
-        uint8_t not1 = onewire_host_read_bit(bus->host);
+        uint8_t not0 = unitemp_onewire_bus_read_bit(bus);
+        uint8_t not1 = unitemp_onewire_bus_read_bit(bus);
         if(!not0) { //If bit zero is present in the addresses
             if(!not1) { //But bit 1 (fork) is also present
                 if(p <
-                   onewire_enum_fork_bit) { //If we are to the left of the past right conflict bit,
+                   bus->enum_fork_bit) { //If we are to the left of the past right conflict bit,
                     if(prev & 1) {
                         next |= 0x80; //then copy the bit value from the previous pass
                     } else {
                         newfork = p; //if zero, then remember the conflict location
                     }
-                } else if(p == onewire_enum_fork_bit) {
+                } else if(p == bus->enum_fork_bit) {
                     next |=
                         0x80; //if at this place last time there was a right conflict with zero, print 1
                 } else {
@@ -296,7 +507,7 @@ uint8_t* unitemp_onewire_bus_enum_next(UnitempOneWireBus* bus) {
                 return 0;
             }
         }
-        onewire_host_write_bit(bus->host, next & 0x80);
+        unitemp_onewire_bus_write_bit(bus, next & 0x80);
         bp--;
         if(!bp) {
             *pprev = next;
@@ -312,6 +523,14 @@ uint8_t* unitemp_onewire_bus_enum_next(UnitempOneWireBus* bus) {
         }
         p++;
     }
-    onewire_enum_fork_bit = newfork;
-    return &onewire_enum[0];
+    bus->enum_fork_bit = newfork;
+    return &bus->enum_id[0];
+}
+
+uint8_t* unitemp_onewire_bus_enum_next(UnitempOneWireBus* bus) {
+    return unitemp_onewire_bus_search_next(bus, 0xF0);
+}
+
+uint8_t* unitemp_onewire_bus_alarm_next(UnitempOneWireBus* bus) {
+    return unitemp_onewire_bus_search_next(bus, 0xEC);
 }
@@ -24,11 +24,17 @@
 
 extern const SensorConnectionInterface unitemp_1w;
 
+//Maximum number of one wire buses (one per GPIO)
+#define UNITEMP_ONEWIRE_BUSES_MAX 13
+//Maximum number of devices in the cached ROM table of a bus
+#define UNITEMP_ONEWIRE_DEVICES_MAX 32
+
 //Device family codes
 typedef enum DallasFamilyCode {
     FC_DS18S20 = 0x10,
     FC_DS1822 = 0x22,
     FC_DS18B20 = 0x28,
+    FC_DS28EA00 = 0x42,
 } DallasFamilyCode;
 
 //Sensor power mode
@@ -37,15 +43,57 @@ typedef enum PowerMode {
     PWR_ACTIVE //Powered by power supply
 } PowerMode;
 
+//Stage of the bus measurement cycle
+typedef enum {
+    UnitempOneWireCycleIdle, //No conversion in progress
+    UnitempOneWireCycleConverting, //All devices are converting the temperature
+    UnitempOneWireCycleReading, //The scratchpads are being read one per bus step
+} UnitempOneWireCycleState;
+
+struct OneWireSensor;
+
 //One wire bus instance
 typedef struct {
     //Sensor connection port
     const SensorGpioPin* bus_pin;
     //Bus host
     OneWireHost* host;
+    //Power mode of the devices: passive if at least one device is powered by the data line
+    PowerMode power_mode;
+    //The host is switched to overdrive speed until the next bus start
+    bool overdrive;
     //Number of devices on the bus
     //Updated when manually adding a sensor to this bus
     int8_t devices_count;
+    //Number of sensors using the bus
+    uint8_t references;
+
+    //Address search state: found address and the last zero bit where there was ambiguity
+    uint8_t enum_id[8];
+    uint8_t enum_fork_bit;
+
+    //Addresses of all devices found on the bus during the last enumeration
+    uint8_t roms[UNITEMP_ONEWIRE_DEVICES_MAX][8];
+    //Overdrive speed support of the devices in the table
+    bool roms_overdrive[UNITEMP_ONEWIRE_DEVICES_MAX];
+    uint8_t roms_count;
+    //Position in the ROM table from which the next scan continues
+    uint8_t scan_cursor;
+
+    //Sensors configured on this bus
+    struct OneWireSensor* sensors[UNITEMP_ONEWIRE_DEVICES_MAX];
+    uint8_t sensors_count;
+
+    //Measurement cycle of the whole bus
+    UnitempOneWireCycleState cycle_state;
+    //Start of the current conversion
+    uint32_t convert_tick;
+    //Duration of the current conversion, ms
+    uint16_t convert_time;
+    //Next sensor to read in the reading stage
+    uint8_t read_cursor;
+    //Next sensor for the background refresh in the alarm search mode
+    uint8_t refresh_cursor;
 } UnitempOneWireBus;
 
 //One wire sensor instance
@@ -56,6 +104,19 @@ typedef struct OneWireSensor {
     uint8_t deviceID[8];
     //Device family code
     DallasFamilyCode family_code;
+    //The device supports overdrive speed
+    bool overdrive;
+    //Measurement resolution (9-12 bits)
+    uint8_t resolution;
+    //Alarm limits (°C): the device responds to the alarm search outside of them
+    int8_t alarm_high;
+    int8_t alarm_low;
+    //Scratchpad read in the last bus cycle
+    uint8_t scratchpad[9];
+    //Status of the last scratchpad reading
+    SensorStatus status;
+    //The scratchpad was read and has not been taken by the sensor yet
+    bool fresh;
 } OneWireSensor;
 
 /**
@@ -70,6 +131,7 @@ UnitempOneWireBus* unitemp_onewire_bus_alloc(const SensorGpioPin* gpio);
  * 
  * @details This function releases all resources associated with the provided
  * OneWire bus structure, including any allocated memory for the bus object itself.
+ * The bus is shared by all sensors on the same port and is freed by the last one.
  * After calling this function, the pointer should not be used.
  * 
  * @param[in] unitemp_one_wire_bus Pointer to the OneWire bus instance to be freed
@@ -93,6 +155,20 @@ bool unitemp_onewire_bus_init(UnitempOneWireBus* bus);
  */
 bool unitemp_onewire_bus_deinit(UnitempOneWireBus* bus);
 
+/**
+ * @brief Advance the measurement cycles of all buses
+ * 
+ * The buses are stepped in turn until none of them is reading, so a long bus
+ * does not hold up the conversion results of the others.
+ */
+void unitemp_onewire_buses_update(void);
+
+/**
+ * @brief Get the time until one of the buses must be stepped
+ * @return Time in ms, UINT32_MAX if no bus is in a measurement cycle
+ */
+uint32_t unitemp_onewire_buses_get_delay(void);
+
 /**
  * @brief Starting communication with sensors on the one wire bus
  * @param bus Pointer to bus
@@ -101,6 +177,30 @@ bool unitemp_onewire_bus_deinit(UnitempOneWireBus* bus);
 bool unitemp_onewire_bus_start(UnitempOneWireBus* bus);
 
 void unitemp_onewire_bus_select_device(UnitempOneWireBus* bus, uint8_t* device_id);
+
+/**
+ * @brief Select the sensor on the bus after the bus start
+ * 
+ * Overdrive-capable devices are selected by OVERDRIVE MATCH ROM when the overdrive is enabled,
+ * the rest of the transaction then runs at overdrive speed.
+ * @param ow_sensor Pointer to the sensor instance
+ */
+void unitemp_onewire_sensor_select(OneWireSensor* ow_sensor);
+
+/**
+ * @brief Address all devices on the bus after the bus start
+ * 
+ * OVERDRIVE SKIP ROM is used when the overdrive is enabled and all sensors of the bus support it.
+ * @param bus Pointer to one wire bus
+ */
+void unitemp_onewire_bus_skip_rom(UnitempOneWireBus* bus);
+
+/**
+ * @brief Check whether the device family supports overdrive speed
+ * @param family_code Device family code
+ * @return True if the devices of the family support overdrive
+ */
+bool unitemp_onewire_family_has_overdrive(uint8_t family_code);
 /**
  * @brief Writing a byte to the one wire bus
  * 
@@ -120,6 +220,15 @@ void unitemp_onewire_bus_write_bytes(UnitempOneWireBus* bus, uint8_t* data, uint
 
 void unitemp_onewire_bus_strong_mode(UnitempOneWireBus* bus, bool state);
 
+/**
+ * @brief Check the power supply of the devices on the bus (READ POWER SUPPLY)
+ * 
+ * The result is stored in the power mode of the bus.
+ * @param bus Pointer to one wire bus
+ * @return True if the devices have responded
+ */
+bool unitemp_onewire_bus_read_power_mode(UnitempOneWireBus* bus);
+
 /**
  * @brief Reading the identifier of a single sensor. 
  * 
@@ -137,6 +246,22 @@ bool unitemp_onewire_sensor_read_id(OneWireSensor* instance);
  */
 void unitemp_onewire_bus_read_bytes(UnitempOneWireBus* bus, uint8_t* data, uint8_t len);
 
+/**
+ * @brief Reading a bit from the One Wire bus
+ * 
+ * @param bus Pointer to one wire bus
+ * @return Value of the bit
+ */
+bool unitemp_onewire_bus_read_bit(UnitempOneWireBus* bus);
+
+/**
+ * @brief Writing a bit to the One Wire bus
+ * 
+ * @param bus Pointer to one wire bus
+ * @param value Value of the bit
+ */
+void unitemp_onewire_bus_write_bit(UnitempOneWireBus* bus, bool value);
+
 /**
  * @brief Compare sensor IDs
  * 
@@ -146,7 +271,30 @@ void unitemp_onewire_bus_read_bytes(UnitempOneWireBus* bus, uint8_t* data, uint8
  */
 bool unitemp_onewire_id_compare(uint8_t* id1, uint8_t* id2);
 
-bool unitemp_onewire_id_exist(uint8_t* id);
+/**
+ * @brief Add the sensor to the set of devices configured on the bus
+ * 
+ * @param bus Pointer to one wire bus
+ * @param ow_sensor Pointer to the sensor instance
+ */
+void unitemp_onewire_bus_add_device(UnitempOneWireBus* bus, OneWireSensor* ow_sensor);
+
+/**
+ * @brief Remove the sensor from the set of devices configured on the bus
+ * 
+ * @param bus Pointer to one wire bus
+ * @param ow_sensor Pointer to the sensor instance
+ */
+void unitemp_onewire_bus_remove_device(UnitempOneWireBus* bus, OneWireSensor* ow_sensor);
+
+/**
+ * @brief Check that a sensor with the address is already configured on the bus
+ * 
+ * @param bus Pointer to one wire bus
+ * @param id Pointer to the device address
+ * @return True if the address is used by one of the sensors
+ */
+bool unitemp_onewire_bus_device_is_configured(UnitempOneWireBus* bus, uint8_t* id);
 
 /**
  * @brief Get the model name of the sensor on the One Wire bus
@@ -169,8 +317,9 @@ bool unitemp_onewire_CRC_check(uint8_t* data, uint8_t len);
 
 /**
  * @brief Initializing the process of searching for addresses on the one wire bus
+ * @param bus Pointer to one wire bus
  */
-void unitemp_onewire_bus_enum_init(void);
+void unitemp_onewire_bus_enum_init(UnitempOneWireBus* bus);
 
 /**
  * @brief Enumerates devices on the one wire bus and gets the next address
@@ -179,6 +328,58 @@ void unitemp_onewire_bus_enum_init(void);
  */
 uint8_t* unitemp_onewire_bus_enum_next(UnitempOneWireBus* bus);
 
+/**
+ * @brief Enumerates the devices in the alarm state (ALARM SEARCH) and gets the next address
+ * 
+ * The search is initialized by unitemp_onewire_bus_enum_init().
+ * @param bus Pointer to one wire bus
+ * @return Returns a pointer to a buffer containing an eight-byte address value, or NULL if the search is completed
+ */
+uint8_t* unitemp_onewire_bus_alarm_next(UnitempOneWireBus* bus);
+
+/**
+ * @brief Enable the alarm search mode of the bus measurement cycles
+ * 
+ * After the conversion only the devices that report an alarm are read,
+ * the others are refreshed in the background one per cycle.
+ * @param enabled True to enable the mode
+ */
+void unitemp_onewire_set_alarm_search(bool enabled);
+
+/**
+ * @brief Check whether the alarm search mode is enabled
+ * @return True if the mode is enabled
+ */
+bool unitemp_onewire_get_alarm_search(void);
+
+/**
+ * @brief Enable overdrive speed for the devices that support it
+ * @param enabled True to enable overdrive
+ */
+void unitemp_onewire_set_overdrive(bool enabled);
+
+/**
+ * @brief Check whether overdrive speed is enabled
+ * @return True if overdrive is enabled
+ */
+bool unitemp_onewire_get_overdrive(void);
+
+/**
+ * @brief Enumerate all devices on the bus into the cached ROM table
+ * @param bus Pointer to one wire bus
+ * @return Number of devices found
+ */
+uint8_t unitemp_onewire_bus_enumerate(UnitempOneWireBus* bus);
+
+/**
+ * @brief Assign the next device of the bus that is not used by other sensors to the sensor
+ * 
+ * The bus is enumerated once, subsequent scans walk the cached ROM table.
+ * The bus is enumerated again when the whole table has been offered.
+ * 
+ * @param ow_sensor Pointer to the sensor instance
+ * @return True if a free device was found
+ */
 bool unitemp_onewire_scan(OneWireSensor* ow_sensor);
 
 #endif
@@ -17,12 +17,24 @@
 */
 
 #include "singlewire_sensor.h"
+#include "../helpers/unitemp_trace.h"
 
 #include "../sensors/DHTxx.h"
 #include "../sensors/AM2320.h"
 
-// Maximum number of polling ticks while waiting for the sensor
-#define POLLING_TIMEOUT_TICKS 5000
+// Wait for the sensor response after the line is released, us
+#define SINGLEWIRE_RESPONSE_TIMEOUT_US 200
+// Shortest and longest valid pulse of the frame, us
+#define SINGLEWIRE_PULSE_MIN_US 10
+#define SINGLEWIRE_PULSE_MAX_US 110
+// High pulse longer than this is a one (zero is 22-30 us, one is 68-75 us)
+#define SINGLEWIRE_BIT_THRESHOLD_US 48
+// Start pulse duration, more than 18 ms
+#define SINGLEWIRE_START_PULSE_MS 19
+// Start pulse of the models that allow 0.8-20 ms only (DHT21, DHT22, AM2320), us
+#define SINGLEWIRE_SHORT_START_PULSE_US 1100
+// Longest frame captured by the interrupt, ms
+#define SINGLEWIRE_FRAME_TIMEOUT_MS 8
 
 const SensorConnectionInterface unitemp_singlewire = {
     .name = "Single wire",
@@ -39,6 +51,8 @@ bool unitemp_singlewire_alloc(Sensor* sensor, char* args) {
         return false;
     }
     sensor->instance = instance;
+    instance->timing_margin = 0;
+    instance->started = false;
 
     int gpio = 255;
     sscanf(args, "%d", &gpio);
@@ -67,7 +81,7 @@ bool unitemp_singlewire_sensor_gpio_set(Sensor* sensor, const SensorGpioPin* dat
     SingleWireSensor* instance = sensor->instance;
     if(instance->data_pin != NULL) unitemp_gpio_unlock(instance->data_pin);
     instance->data_pin = data_pin;
-    unitemp_gpio_lock(instance->data_pin, &unitemp_singlewire);
+    unitemp_gpio_lock(instance->data_pin, &unitemp_singlewire, sensor);
     return true;
 }
 
@@ -77,6 +91,29 @@ const SensorGpioPin* unitemp_singlewire_sensor_gpio_get(Sensor* sensor) {
     return instance->data_pin;
 }
 
+/**
+ * @brief Check if the start pulse of the sensor model has an upper limit
+ * 
+ * Such a pulse is timed in place: the poller serves other sensors for tens of ms
+ * and the split poll would make it too long.
+ * @param sensor Pointer to sensor
+ * @return True for DHT21, DHT22 and AM2320
+ */
+static bool unitemp_singlewire_has_short_start(Sensor* sensor) {
+    return sensor->model == &DHT21 || sensor->model == &DHT22 || sensor->model == &AM2320_SW;
+}
+
+/**
+ * @brief Put the start pulse on the line
+ * @param instance Pointer to the sensor instance
+ */
+static void unitemp_singlewire_start(SingleWireSensor* instance) {
+    // Pull the line low
+    furi_hal_gpio_write(instance->data_pin->pin, false);
+    instance->start_tick = furi_get_tick();
+    instance->started = true;
+}
+
 bool unitemp_singlewire_init(Sensor* sensor) {
     if(sensor == NULL) return false;
 
@@ -94,6 +131,11 @@ bool unitemp_singlewire_init(Sensor* sensor) {
         GpioPullUp, // Force pull-up of the data line to power
         GpioSpeedVeryHigh); // Operating speed - maximum
     sensor->last_polling_time = furi_get_tick();
+    //The first reading is waited for
+    if(!unitemp_singlewire_has_short_start(sensor)) {
+        unitemp_singlewire_start(instance);
+        furi_delay_ms(SINGLEWIRE_START_PULSE_MS);
+    }
     return (unitemp_singlewire_update(sensor) == UT_SENSORSTATUS_OK);
 }
 
@@ -113,90 +155,181 @@ bool unitemp_singlewire_deinit(Sensor* sensor) {
     return true;
 }
 
-SensorStatus unitemp_singlewire_update(Sensor* sensor) {
-    if(sensor == NULL) return UT_SENSORSTATUS_ERROR;
-    SingleWireSensor* instance = sensor->instance;
+//Check that the pulse duration is within the frame timings
+static inline bool unitemp_singlewire_pulse_valid(uint32_t duration) {
+    return duration >= SINGLEWIRE_PULSE_MIN_US && duration <= SINGLEWIRE_PULSE_MAX_US;
+}
 
-    // Array for receiving data
-    uint8_t data[5] = {0};
+//Timestamp the line edge. Runs in the interrupt
+static void unitemp_singlewire_edge_callback(void* context) {
+    SingleWireSensor* instance = context;
+    uint32_t now = DWT->CYCCNT;
+    //The frame starts with the falling edge of the response
+    if(instance->edges_count == 0 && furi_hal_gpio_read(instance->data_pin->pin)) return;
+    if(instance->edges_count < SINGLEWIRE_FRAME_EDGES) {
+        instance->edges[instance->edges_count++] = now;
+    }
+}
 
-    /* Request */
-    // Pull the line low
-    furi_hal_gpio_write(instance->data_pin->pin, false);
-    // Wait more than 18 ms
-    furi_delay_ms(19);
-    // Disable interrupts to ensure accurate timing
-    FURI_CRITICAL_ENTER();
-    // Raise the line
-    furi_hal_gpio_write(instance->data_pin->pin, true);
+/**
+ * @brief Release the lines and capture the frame edges by the external interrupts
+ * 
+ * Interrupts stay enabled and the thread sleeps until the frames are over.
+ * @param instances Array of pointers to the sensor instances with distinct interrupt lines
+ * @param count Number of sensors
+ */
+static void unitemp_singlewire_capture_exti(SingleWireSensor** instances, uint8_t count) {
+    for(uint8_t i = 0; i < count; i++) {
+        const GpioPin* pin = instances[i]->data_pin->pin;
+        instances[i]->edges_count = 0;
+        furi_hal_gpio_add_int_callback(pin, unitemp_singlewire_edge_callback, instances[i]);
+        // Raise the line
+        furi_hal_gpio_write(pin, true);
+        instances[i]->release = DWT->CYCCNT;
+        furi_hal_gpio_init(pin, GpioModeInterruptRiseFall, GpioPullUp, GpioSpeedVeryHigh);
+    }
 
-    /* Sensor response */
-    // Counter variable
-    uint16_t timeout = 0;
-
-    // Wait for the line to go high
-    while(!furi_hal_gpio_read(instance->data_pin->pin)) {
-        timeout++;
-        if(timeout > POLLING_TIMEOUT_TICKS) {
-            // Enable interrupts
-            FURI_CRITICAL_EXIT();
-            // Return the indicator of a missing sensor
-            return UT_SENSORSTATUS_TIMEOUT;
+    uint32_t start = furi_get_tick();
+    for(uint8_t i = 0; i < count; i++) {
+        while(instances[i]->edges_count < SINGLEWIRE_FRAME_EDGES &&
+              furi_get_tick() - start < furi_ms_to_ticks(SINGLEWIRE_FRAME_TIMEOUT_MS)) {
+            furi_delay_tick(1);
         }
     }
-    timeout = 0;
 
-    // Wait for the line to go low
-    while(furi_hal_gpio_read(instance->data_pin->pin)) {
-        timeout++;
-        if(timeout > POLLING_TIMEOUT_TICKS) {
-            // Enable interrupts
-            FURI_CRITICAL_EXIT();
-            // Return the indicator of a missing sensor
-            return UT_SENSORSTATUS_TIMEOUT;
-        }
+    for(uint8_t i = 0; i < count; i++) {
+        const GpioPin* pin = instances[i]->data_pin->pin;
+        furi_hal_gpio_remove_int_callback(pin);
+        furi_hal_gpio_init(pin, GpioModeOutputOpenDrain, GpioPullUp, GpioSpeedVeryHigh);
     }
+}
 
-    // Wait for the line to go high
-    while(!furi_hal_gpio_read(instance->data_pin->pin)) {
-        timeout++;
-        if(timeout > POLLING_TIMEOUT_TICKS) {
-            // Enable interrupts
-            FURI_CRITICAL_EXIT();
-            // Return the indicator of a missing sensor
-            return UT_SENSORSTATUS_TIMEOUT;
+/**
+ * @brief Release the lines and capture the frame edges by polling the lines
+ * 
+ * Used on the pins whose interrupt line is taken. All lines are sampled in one loop
+ * with interrupts disabled, the capture of a line ends at the first pulse longer
+ * than the frame timings allow.
+ * @param instances Array of pointers to the sensor instances
+ * @param count Number of sensors
+ */
+static void unitemp_singlewire_capture_polled(SingleWireSensor** instances, uint8_t count) {
+    const uint32_t cycles_per_us = furi_hal_cortex_instructions_per_microsecond();
+    //Time of the last edge, the level and the end of the capture of every line
+    uint32_t edge[SINGLEWIRE_SENSORS_MAX];
+    bool level[SINGLEWIRE_SENSORS_MAX];
+    bool done[SINGLEWIRE_SENSORS_MAX];
+    uint8_t active = count;
+
+    // Disable interrupts to ensure accurate timing
+    FURI_CRITICAL_ENTER();
+    for(uint8_t i = 0; i < count; i++) {
+        instances[i]->edges_count = 0;
+        // Raise the line
+        furi_hal_gpio_write(instances[i]->data_pin->pin, true);
+        instances[i]->release = DWT->CYCCNT;
+        edge[i] = instances[i]->release;
+        level[i] = true;
+        done[i] = false;
+    }
+    while(active > 0) {
+        for(uint8_t i = 0; i < count; i++) {
+            SingleWireSensor* instance = instances[i];
+            if(done[i]) continue;
+            uint32_t now = DWT->CYCCNT;
+            if(furi_hal_gpio_read(instance->data_pin->pin) != level[i]) {
+                instance->edges[instance->edges_count++] = now;
+                edge[i] = now;
+                level[i] = !level[i];
+                done[i] = instance->edges_count == SINGLEWIRE_FRAME_EDGES;
+            } else {
+                uint32_t timeout = instance->edges_count == 0 ? SINGLEWIRE_RESPONSE_TIMEOUT_US :
+                                                                SINGLEWIRE_PULSE_MAX_US;
+                done[i] = now - edge[i] > timeout * cycles_per_us;
+            }
+            if(done[i]) active--;
         }
     }
-    timeout = 0;
+    // Enable interrupts
+    FURI_CRITICAL_EXIT();
+}
 
-    // Wait for the line to go low
-    while(furi_hal_gpio_read(instance->data_pin->pin)) {
-        timeout++;
-        if(timeout > POLLING_TIMEOUT_TICKS) {
-            // Enable interrupts
-            FURI_CRITICAL_EXIT();
-            // Return the indicator of a missing sensor
-            return UT_SENSORSTATUS_TIMEOUT;
-        }
+/**
+ * @brief Decode the captured frame
+ * 
+ * The bit value is given by the length of the high pulse after the 50 us low one.
+ * @param sensor Pointer to sensor
+ * @param data Pointer to a 5-byte array for the frame
+ * @return Decoding status
+ */
+static SensorStatus unitemp_singlewire_decode(Sensor* sensor, uint8_t* data) {
+    SingleWireSensor* instance = sensor->instance;
+    const uint32_t cycles_per_us = furi_hal_cortex_instructions_per_microsecond();
+    const uint8_t count = instance->edges_count;
+
+    // The sensor responds by pulling the line low
+    if(count == 0 ||
+       (instance->edges[0] - instance->release) / cycles_per_us >
+           SINGLEWIRE_RESPONSE_TIMEOUT_US) {
+        return UT_SENSORSTATUS_TIMEOUT;
     }
 
-    /* Reading data from the sensor */
-    // Receive 5 bytes
-    for(uint8_t a = 0; a < 5; a++) {
-        for(uint8_t b = 7; b != 255; b--) {
-            uint16_t hT = 0, lT = 0;
-            // While the line is low, increment the lT variable
-            while(!furi_hal_gpio_read(instance->data_pin->pin) && lT != 65535)
-                lT++;
-            // While the line is high, increment the hT variable
-            while(furi_hal_gpio_read(instance->data_pin->pin) && hT != 65535)
-                hT++;
-            // If hT is greater than lT, a one was received
-            if(hT > lT) data[a] |= (1 << b);
+    uint32_t margin = UINT32_MAX;
+    for(uint8_t i = 1; i < count; i++) {
+        uint32_t pulse = (instance->edges[i] - instance->edges[i - 1]) / cycles_per_us;
+        // Out of spec pulses abort the frame at once
+        if(!unitemp_singlewire_pulse_valid(pulse)) {
+            UNITEMP_DEBUG("Sensor %s pulse %d is %lu us", sensor->name, i, pulse);
+            return i < 3 ? UT_SENSORSTATUS_TIMEOUT : UT_SENSORSTATUS_BADCRC;
         }
+        // Falling edges from the fifth one end the high pulses of the bits
+        if(i < 4 || i % 2) continue;
+
+        uint8_t bit = (i - 4) / 2;
+        uint32_t bit_margin;
+        if(pulse > SINGLEWIRE_BIT_THRESHOLD_US) {
+            data[bit / 8] |= 1 << (7 - bit % 8);
+            bit_margin = pulse - SINGLEWIRE_BIT_THRESHOLD_US;
+        } else {
+            bit_margin = SINGLEWIRE_BIT_THRESHOLD_US - pulse;
+        }
+        if(bit_margin < margin) margin = bit_margin;
     }
-    // Enable interrupts
-    FURI_CRITICAL_EXIT();
+    if(count < SINGLEWIRE_FRAME_EDGES) {
+        UNITEMP_DEBUG("Sensor %s frame broken after %d edges", sensor->name, count);
+        return count < 3 ? UT_SENSORSTATUS_TIMEOUT : UT_SENSORSTATUS_BADCRC;
+    }
+
+    instance->timing_margin = margin;
+    UNITEMP_DEBUG("Sensor %s bit timing margin %lu us", sensor->name, margin);
+    return UT_SENSORSTATUS_OK;
+}
+
+bool unitemp_singlewire_sensor_is_ready(Sensor* sensor) {
+    if(sensor == NULL || sensor->model->interface != &unitemp_singlewire) return false;
+    return ((SingleWireSensor*)sensor->instance)->started ||
+           unitemp_singlewire_has_short_start(sensor);
+}
+
+/**
+ * @brief Convert the captured frame of the sensor to the values
+ * @param sensor Pointer to sensor
+ * @return Poll status
+ */
+static SensorStatus unitemp_singlewire_read(Sensor* sensor) {
+    // Array for receiving data
+    uint8_t data[5] = {0};
+
+    // The decoded frame is traced, the edge timings are not
+    const uint8_t pin = ((SingleWireSensor*)sensor->instance)->data_pin->num;
+    uint8_t result = UT_SENSORSTATUS_TIMEOUT;
+    if(!unitemp_trace_replay_read(UnitempTraceBusSingleWire, pin, 0, data, 5, &result)) {
+        result = unitemp_singlewire_decode(sensor, data);
+        unitemp_trace_record(
+            UnitempTraceBusSingleWire, UnitempTraceDirRead, pin, 0, data, 5, result);
+    }
+    SensorStatus status = result;
+    if(status != UT_SENSORSTATUS_OK) return status;
 
     // Check the checksum
     if((uint8_t)(data[0] + data[1] + data[2] + data[3]) != data[4]) {
@@ -248,3 +381,77 @@ SensorStatus unitemp_singlewire_update(Sensor* sensor) {
     // Return the successful poll indicator
     return UT_SENSORSTATUS_OK;
 }
+
+void unitemp_singlewire_sensors_update(Sensor** sensors, SensorStatus* statuses, uint8_t count) {
+    furi_check(count <= SINGLEWIRE_SENSORS_MAX);
+    SingleWireSensor* exti_group[SINGLEWIRE_SENSORS_MAX];
+    SingleWireSensor* polled_group[SINGLEWIRE_SENSORS_MAX];
+    uint8_t exti_count = 0, polled_count = 0;
+    //Interrupt lines taken by the group
+    uint16_t exti_lines = 0;
+
+    // The start pulses are finished if the sensors are continued earlier
+    uint32_t wait = 0;
+    for(uint8_t i = 0; i < count; i++) {
+        if(unitemp_singlewire_has_short_start(sensors[i])) continue;
+        SingleWireSensor* instance = sensors[i]->instance;
+        uint32_t elapsed = furi_get_tick() - instance->start_tick;
+        if(elapsed < furi_ms_to_ticks(SINGLEWIRE_START_PULSE_MS) &&
+           furi_ms_to_ticks(SINGLEWIRE_START_PULSE_MS) - elapsed > wait) {
+            wait = furi_ms_to_ticks(SINGLEWIRE_START_PULSE_MS) - elapsed;
+        }
+    }
+    if(wait > 0) furi_delay_tick(wait);
+
+    // The short start pulses are put on the lines together and released by the capture
+    bool short_start = false;
+    for(uint8_t i = 0; i < count; i++) {
+        if(!unitemp_singlewire_has_short_start(sensors[i])) continue;
+        unitemp_singlewire_start(sensors[i]->instance);
+        short_start = true;
+    }
+    if(short_start) furi_delay_us(SINGLEWIRE_SHORT_START_PULSE_US);
+
+    for(uint8_t i = 0; i < count; i++) {
+        SingleWireSensor* instance = sensors[i]->instance;
+        instance->started = false;
+        sensors[i]->resume_delay = 0;
+        //The pins with the same number share the interrupt line
+        uint16_t line = instance->data_pin->pin->pin;
+        if(unitemp_gpio_exti_available(instance->data_pin) && !(exti_lines & line)) {
+            exti_lines |= line;
+            exti_group[exti_count++] = instance;
+        } else {
+            polled_group[polled_count++] = instance;
+        }
+    }
+
+    /* Sensor response */
+    // The frames of the replayed trace are not captured
+    if(unitemp_trace_is_replaying()) exti_count = polled_count = 0;
+    if(exti_count > 0) unitemp_singlewire_capture_exti(exti_group, exti_count);
+    if(polled_count > 0) unitemp_singlewire_capture_polled(polled_group, polled_count);
+
+    /* Reading data from the sensors */
+    for(uint8_t i = 0; i < count; i++) {
+        statuses[i] = unitemp_singlewire_read(sensors[i]);
+    }
+}
+
+SensorStatus unitemp_singlewire_update(Sensor* sensor) {
+    if(sensor == NULL) return UT_SENSORSTATUS_ERROR;
+    SingleWireSensor* instance = sensor->instance;
+
+    /* Request */
+    // The start pulse limited from above is timed in place by the frame capture
+    if(!instance->started && !unitemp_singlewire_has_short_start(sensor)) {
+        // The poll is continued after the start pulse, other sensors are served meanwhile
+        unitemp_singlewire_start(instance);
+        sensor->resume_delay = SINGLEWIRE_START_PULSE_MS;
+        return UT_SENSORSTATUS_POLLING;
+    }
+
+    SensorStatus status;
+    unitemp_singlewire_sensors_update(&sensor, &status, 1);
+    return status;
+}
@@ -22,10 +22,29 @@
 #include "../sensors.h"
 #include "../helpers/unitemp_gpio.h"
 
+//Number of bits in a frame
+#define SINGLEWIRE_FRAME_BITS 40
+//Number of edges in a frame: three of the response and two per bit
+#define SINGLEWIRE_FRAME_EDGES (3 + 2 * SINGLEWIRE_FRAME_BITS)
+//Maximum number of sensors captured at once, each one takes its own pin
+#define SINGLEWIRE_SENSORS_MAX 13
+
 //Single Wire Interface stcructure
 typedef struct {
     //Sensor connection port
     const SensorGpioPin* data_pin;
+    //Smallest distance of a bit pulse from the decision threshold in the last frame, us
+    uint32_t timing_margin;
+    //Edge times of the captured frame (CPU cycles)
+    uint32_t edges[SINGLEWIRE_FRAME_EDGES];
+    //Number of captured edges, written by the interrupt during the capture
+    volatile uint8_t edges_count;
+    //The start pulse is on the line
+    bool started;
+    //Start pulse time
+    uint32_t start_tick;
+    //Time of the line release at the end of the start pulse (CPU cycles)
+    uint32_t release;
 } SingleWireSensor;
 
 extern const SensorConnectionInterface
@@ -72,6 +91,28 @@ bool unitemp_singlewire_deinit(Sensor* sensor);
  */
 SensorStatus unitemp_singlewire_update(Sensor* sensor);
 
+/**
+ * @brief Check that the next update of the sensor captures its frame
+ * 
+ * The start pulse of the sensor is on the line, or the model takes the short start
+ * pulse that is put on the line by the frame capture itself.
+ * @param sensor Pointer to sensor
+ * @return True if the sensor can join the group capture
+ */
+bool unitemp_singlewire_sensor_is_ready(Sensor* sensor);
+
+/**
+ * @brief Capture the frames of several ready sensors at once
+ * 
+ * The split start pulses are waited for, then the short start pulses are put on
+ * the lines together. The sensors with free and distinct interrupt lines are captured
+ * together by the interrupts, the rest are sampled together in one polling loop.
+ * @param sensors Array of pointers to the ready sensors
+ * @param statuses Array for the poll statuses of the sensors
+ * @param count Number of sensors
+ */
+void unitemp_singlewire_sensors_update(Sensor** sensors, SensorStatus* statuses, uint8_t count);
+
 /**
  * @brief Set sensor port
  * 
@@ -18,7 +18,9 @@
 
 #include <furi.h>
 #include <furi_hal.h>
+#include <stm32wbxx_ll_spi.h>
 #include "spi_sensor.h"
+#include "../helpers/unitemp_trace.h"
 
 const SensorConnectionInterface unitemp_spi = {
     .name = "SPI",
@@ -27,6 +29,16 @@ const SensorConnectionInterface unitemp_spi = {
     .updater = unitemp_spi_sensor_update};
 
 static uint8_t sensors_count = 0;
+//Handle of the external SPI bus shared by all sensors, CS is switched to the polled sensor
+static FuriHalSpiBusHandle spi_bus_handle;
+
+//Prescalers of the 64 MHz bus clock and their frequencies by UnitempSPIClock
+static const uint32_t spi_clock_prescalers[UnitempSPIClockCount] = {
+    LL_SPI_BAUDRATEPRESCALER_DIV128,
+    LL_SPI_BAUDRATEPRESCALER_DIV64,
+    LL_SPI_BAUDRATEPRESCALER_DIV32,
+    LL_SPI_BAUDRATEPRESCALER_DIV16};
+static const char* spi_clock_names[UnitempSPIClockCount] = {"500 kHz", "1 MHz", "2 MHz", "4 MHz"};
 
 bool unitemp_spi_sensor_alloc(Sensor* sensor, char* args) {
     if(args == NULL) return false;
@@ -39,9 +51,10 @@ bool unitemp_spi_sensor_alloc(Sensor* sensor, char* args) {
     }
     sensor->instance = instance;
 
-    //Definition GPIO chip select
+    //Definition GPIO chip select. Sensors saved without the clock use the default 2 MHz
     int gpio = 255;
-    sscanf(args, "%d", &gpio);
+    int clock = UnitempSPIClock2M, fast_capture = 0;
+    sscanf(args, "%d %d %d", &gpio, &clock, &fast_capture);
     instance->cs_pin = unitemp_gpio_get_from_int(gpio);
     if(instance->cs_pin == NULL) {
         FURI_LOG_E(APP_NAME, "Sensor %s GPIO setting error", sensor->name);
@@ -49,26 +62,34 @@ bool unitemp_spi_sensor_alloc(Sensor* sensor, char* args) {
         return false;
     }
 
-    instance->spi = malloc(sizeof(FuriHalSpiBusHandle));
-    memcpy(instance->spi, &furi_hal_spi_bus_handle_external, sizeof(FuriHalSpiBusHandle));
-
-    instance->spi->cs = instance->cs_pin->pin;
+    if(sensors_count == 0) {
+        memcpy(&spi_bus_handle, &furi_hal_spi_bus_handle_external, sizeof(FuriHalSpiBusHandle));
+    }
+    instance->spi = &spi_bus_handle;
+    //Models with a plain frame set the frame size and the decoder in their allocator
+    instance->frame_size = 0;
+    instance->decode = NULL;
+    instance->sensor_instance = NULL;
+    instance->clock = (clock >= 0 && clock < UnitempSPIClockCount) ? clock : UnitempSPIClock2M;
+    instance->conversion_time = 0;
+    instance->capture = NULL;
 
     bool status = sensor->model->allocator(sensor, args);
+    if(status && fast_capture) unitemp_spi_sensor_set_fast_capture(sensor, true);
 
     //Blocking GPIO ports
     sensors_count++;
-    unitemp_gpio_lock(unitemp_gpio_get_from_int(2), &unitemp_spi);
-    unitemp_gpio_lock(unitemp_gpio_get_from_int(3), &unitemp_spi);
-    unitemp_gpio_lock(unitemp_gpio_get_from_int(5), &unitemp_spi);
-    unitemp_gpio_lock(instance->cs_pin, &unitemp_spi);
+    unitemp_gpio_lock(unitemp_gpio_get_from_int(2), &unitemp_spi, NULL);
+    unitemp_gpio_lock(unitemp_gpio_get_from_int(3), &unitemp_spi, NULL);
+    unitemp_gpio_lock(unitemp_gpio_get_from_int(5), &unitemp_spi, NULL);
+    unitemp_gpio_lock(instance->cs_pin, &unitemp_spi, sensor);
     return status;
 }
 
 bool unitemp_spi_sensor_free(Sensor* sensor) {
     bool status = sensor->model->mem_releaser(sensor);
     unitemp_gpio_unlock(((SPISensor*)sensor->instance)->cs_pin);
-    free(((SPISensor*)(sensor->instance))->spi);
+    free(((SPISensor*)sensor->instance)->capture);
     free(sensor->instance);
 
     if(--sensors_count == 0) {
@@ -93,3 +114,134 @@ bool unitemp_spi_sensor_deinit(Sensor* sensor) {
 SensorStatus unitemp_spi_sensor_update(Sensor* sensor) {
     return sensor->model->updater(sensor);
 }
+
+void unitemp_spi_sensor_cs_init(SPISensor* instance) {
+    //The init event of the handle configures its CS pin
+    spi_bus_handle.cs = instance->cs_pin->pin;
+    furi_hal_spi_bus_handle_init(&spi_bus_handle);
+}
+
+const char* unitemp_spi_clock_get_name(UnitempSPIClock clock) {
+    if(clock >= UnitempSPIClockCount) return "?";
+    return spi_clock_names[clock];
+}
+
+bool unitemp_spi_sensor_set_fast_capture(Sensor* sensor, bool enabled) {
+    SPISensor* instance = sensor->instance;
+    if(enabled && instance->conversion_time == 0) return false;
+
+    if(enabled && instance->capture == NULL) {
+        instance->capture = malloc(sizeof(UnitempSPICapture));
+        if(instance->capture == NULL) {
+            FURI_LOG_E(APP_NAME, "Sensor %s capture allocation error", sensor->name);
+            return false;
+        }
+        instance->capture->head = 0;
+        instance->capture->count = 0;
+    } else if(!enabled && instance->capture != NULL) {
+        free(instance->capture);
+        instance->capture = NULL;
+    }
+    //A poll ahead of the end of the conversion returns the previous value again
+    sensor->polling_interval = enabled ? instance->conversion_time + SPI_CAPTURE_MARGIN_MS :
+                                         sensor->model->polling_interval;
+    return true;
+}
+
+uint8_t unitemp_spi_sensor_get_capture(Sensor* sensor, float* values, uint8_t count) {
+    if(sensor->model->interface != &unitemp_spi) return 0;
+    UnitempSPICapture* capture = ((SPISensor*)sensor->instance)->capture;
+    if(capture == NULL) return 0;
+
+    if(count > capture->count) count = capture->count;
+    //The oldest of the requested values
+    uint8_t index = (capture->head + SPI_CAPTURE_SIZE - count) % SPI_CAPTURE_SIZE;
+    for(uint8_t i = 0; i < count; i++) {
+        values[i] = capture->values[index];
+        index = (index + 1) % SPI_CAPTURE_SIZE;
+    }
+    return count;
+}
+
+bool unitemp_spi_sensor_is_batched(Sensor* sensor) {
+    if(sensor->model->interface != &unitemp_spi) return false;
+    SPISensor* instance = sensor->instance;
+    return instance->frame_size > 0 && instance->decode != NULL;
+}
+
+/**
+ * @brief Clock out the frames of the sensors in one bus acquisition
+ * @param sensors Array of sensors supporting the batch read
+ * @param count Number of sensors
+ */
+static void unitemp_spi_sensors_read_frames(Sensor** sensors, uint8_t count) {
+    //The handle activation pulls its CS low, so it points to the first sensor
+    spi_bus_handle.cs = ((SPISensor*)sensors[0]->instance)->cs_pin->pin;
+    furi_hal_spi_acquire(&spi_bus_handle);
+    SPI_TypeDef* spi = spi_bus_handle.bus->spi;
+    for(uint8_t i = 0; i < count; i++) {
+        SPISensor* instance = sensors[i]->instance;
+        //The clock is changed only between the frames, while the bus is idle
+        uint32_t prescaler = spi_clock_prescalers[instance->clock];
+        if(LL_SPI_GetBaudRatePrescaler(spi) != prescaler) {
+            LL_SPI_Disable(spi);
+            LL_SPI_SetBaudRatePrescaler(spi, prescaler);
+            LL_SPI_Enable(spi);
+        }
+        memset(instance->frame, 0, SPI_FRAME_MAX);
+        furi_hal_gpio_write(instance->cs_pin->pin, false);
+        furi_hal_spi_bus_rx(&spi_bus_handle, instance->frame, instance->frame_size, 0xFF);
+        furi_hal_gpio_write(instance->cs_pin->pin, true);
+    }
+    furi_hal_spi_release(&spi_bus_handle);
+
+    //The frames are traced after the release to keep them back to back
+    for(uint8_t i = 0; i < count; i++) {
+        SPISensor* instance = sensors[i]->instance;
+        unitemp_trace_record(
+            UnitempTraceBusSPI,
+            UnitempTraceDirRead,
+            instance->cs_pin->num,
+            0,
+            instance->frame,
+            instance->frame_size,
+            true);
+    }
+}
+
+void unitemp_spi_sensors_update_batched(
+    Sensor** sensors,
+    SensorStatus* statuses,
+    uint8_t count) {
+    if(count == 0) return;
+
+    if(unitemp_trace_is_replaying()) {
+        for(uint8_t i = 0; i < count; i++) {
+            SPISensor* instance = sensors[i]->instance;
+            //A frame missing from the trace reads as the idle MISO line
+            memset(instance->frame, 0xFF, SPI_FRAME_MAX);
+            uint8_t result;
+            unitemp_trace_replay_read(
+                UnitempTraceBusSPI,
+                instance->cs_pin->num,
+                0,
+                instance->frame,
+                instance->frame_size,
+                &result);
+        }
+    } else {
+        unitemp_spi_sensors_read_frames(sensors, count);
+    }
+
+    for(uint8_t i = 0; i < count; i++) {
+        SPISensor* instance = sensors[i]->instance;
+        statuses[i] = instance->decode(sensors[i], instance->frame);
+        //Every conversion is kept in the fast capture mode, without the user offset
+        if(statuses[i] == UT_SENSORSTATUS_OK && instance->capture != NULL) {
+            UnitempSPICapture* capture = instance->capture;
+            capture->values[capture->head] = sensors[i]->temperature;
+            capture->head = (capture->head + 1) % SPI_CAPTURE_SIZE;
+            if(capture->count < SPI_CAPTURE_SIZE) capture->count++;
+        }
+    }
+}
@@ -24,12 +24,63 @@
 
 extern const SensorConnectionInterface unitemp_spi;
 
+//Maximum number of SPI sensors (one per free CS pin)
+#define SPI_SENSORS_MAX 10
+//Maximum size of the frame read from the sensor (bytes)
+#define SPI_FRAME_MAX   4
+//Number of values kept by the fast capture
+#define SPI_CAPTURE_SIZE 32
+//Time added to the conversion time so that every poll gets a new conversion (ms)
+#define SPI_CAPTURE_MARGIN_MS 10
+
+//Bus clock while the sensor is read
+typedef enum {
+    UnitempSPIClock500K,
+    UnitempSPIClock1M,
+    UnitempSPIClock2M,
+    UnitempSPIClock4M,
+
+    UnitempSPIClockCount
+} UnitempSPIClock;
+
+//Ring of the values captured at the sensor conversion rate
+typedef struct {
+    //Temperatures in the order of capture, °C
+    float values[SPI_CAPTURE_SIZE];
+    //Index where the next value will be written
+    uint8_t head;
+    //Number of captured values
+    uint8_t count;
+} UnitempSPICapture;
+
+/**
+ * @brief Conversion of the frame read from the sensor to the values
+ * @param sensor Pointer to sensor
+ * @param frame Frame read from the sensor
+ * @return Sensor poll status
+ */
+typedef SensorStatus(UnitempSPIDecode)(Sensor* sensor, const uint8_t* frame);
+
 //SPI sensor structure
 typedef struct SPISensor {
-    //Pointer to SPI interface
+    //Pointer to the shared handle of the SPI bus
     FuriHalSpiBusHandle* spi;
     //CS connection port
     const SensorGpioPin* cs_pin;
+    //Frame size (bytes), set by the model allocator
+    uint8_t frame_size;
+    //Last frame read from the sensor
+    uint8_t frame[SPI_FRAME_MAX];
+    //Conversion of the frame, set by the model allocator
+    UnitempSPIDecode* decode;
+    //Pointer to its own sensor instance
+    void* sensor_instance;
+    //Bus clock while the sensor is read
+    UnitempSPIClock clock;
+    //Conversion time (ms) set by the model allocator, 0 if the model has no fast capture
+    uint16_t conversion_time;
+    //Values captured in the fast capture mode, NULL if the mode is disabled
+    UnitempSPICapture* capture;
 } SPISensor;
 
 /**
@@ -66,4 +117,60 @@ bool unitemp_spi_sensor_deinit(Sensor* sensor);
  */
 SensorStatus unitemp_spi_sensor_update(Sensor* sensor);
 
+/**
+ * @brief Set the sensor CS pin to the inactive state
+ * @param instance Pointer to SPI sensor instance
+ */
+void unitemp_spi_sensor_cs_init(SPISensor* instance);
+
+/**
+ * @brief Get the name of the bus clock
+ * @param clock Bus clock
+ * @return Pointer to the string with the frequency
+ */
+const char* unitemp_spi_clock_get_name(UnitempSPIClock clock);
+
+/**
+ * @brief Set the fast capture mode of the sensor
+ * 
+ * In the fast capture mode the sensor is polled right after each conversion
+ * instead of the model polling interval and every value is kept in a ring.
+ * The ring is plotted under the temperature in the sensor view.
+ * @param sensor Pointer to sensor
+ * @param enabled True to enable the mode
+ * @return True if the mode has been set
+ */
+bool unitemp_spi_sensor_set_fast_capture(Sensor* sensor, bool enabled);
+
+/**
+ * @brief Get the values captured in the fast capture mode
+ * @param sensor Pointer to sensor
+ * @param values Array where the values will be written from the oldest to the newest
+ * @param count Size of the array
+ * @return Number of written values
+ */
+uint8_t unitemp_spi_sensor_get_capture(Sensor* sensor, float* values, uint8_t count);
+
+/**
+ * @brief Check that the sensor can be read in a batch
+ * @param sensor Pointer to sensor
+ * @return True if the sensor is on the SPI bus and its model reads a plain frame
+ */
+bool unitemp_spi_sensor_is_batched(Sensor* sensor);
+
+/**
+ * @brief Batch read of several SPI sensors
+ * 
+ * The bus is acquired once, the frames of all sensors are clocked out
+ * back to back by switching CS, then the frames are decoded in order.
+ * 
+ * @param sensors Array of sensors supporting the batch read
+ * @param statuses Array where the poll statuses will be written
+ * @param count Number of sensors
+ */
+void unitemp_spi_sensors_update_batched(
+    Sensor** sensors,
+    SensorStatus* statuses,
+    uint8_t count);
+
 #endif
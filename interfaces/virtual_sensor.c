@@ -0,0 +1,154 @@
+/*
+    Unitemp - Universal temperature reader
+    Copyright (C) 2022-2026  Victor Nikitchuk (https://github.com/quen0n)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <furi.h>
+#include <math.h>
+#include "virtual_sensor.h"
+
+const SensorConnectionInterface unitemp_virtual = {
+    .name = "Virtual",
+    .allocator = unitemp_virtual_alloc,
+    .mem_releaser = unitemp_virtual_free,
+    .updater = unitemp_virtual_update};
+
+static const char* virtual_wave_names[VirtualWaveCount] =
+    {"Sine", "Ramp", "Noise", "Step", "Dropout", "Bad CRC"};
+//Selectable conversion latencies, ms
+static const uint16_t virtual_latencies[] = {0, 10, 50, 100, 250, 500, 1000};
+
+bool unitemp_virtual_alloc(Sensor* sensor, char* args) {
+    if(sensor == NULL || args == NULL) return false;
+
+    VirtualSensor* instance = malloc(sizeof(VirtualSensor));
+    if(instance == NULL) {
+        FURI_LOG_E(APP_NAME, "Sensor %s instance allocation error", sensor->name);
+        return false;
+    }
+    sensor->instance = instance;
+
+    //New sensors get a sine without latency
+    int wave = VirtualWaveSine, latency = 0;
+    sscanf(args, "%d %d", &wave, &latency);
+    instance->wave = (wave >= 0 && wave < VirtualWaveCount) ? wave : VirtualWaveSine;
+    instance->latency = (latency >= 0 && latency <= UINT16_MAX) ? latency : 0;
+
+    //FNV-1a hash of the name, sensors with the same name produce the same noise
+    instance->seed = 2166136261UL;
+    for(const char* c = sensor->name; *c != '\0'; c++) {
+        instance->seed = (instance->seed ^ (uint8_t)*c) * 16777619UL;
+    }
+    instance->sample = 0;
+    instance->noise = instance->seed;
+    instance->converting = false;
+    return true;
+}
+
+bool unitemp_virtual_free(Sensor* sensor) {
+    free(sensor->instance);
+    return true;
+}
+
+bool unitemp_virtual_init(Sensor* sensor) {
+    VirtualSensor* instance = sensor->instance;
+    instance->sample = 0;
+    instance->noise = instance->seed;
+    instance->converting = false;
+    return true;
+}
+
+bool unitemp_virtual_deinit(Sensor* sensor) {
+    UNUSED(sensor);
+    return true;
+}
+
+/**
+ * @brief Get the level of the waveform
+ * @param instance Pointer to the virtual sensor instance
+ * @param sample Sample number
+ * @return Level from -1 to 1
+ */
+static float unitemp_virtual_get_level(VirtualSensor* instance, uint32_t sample) {
+    uint32_t phase = sample % VIRTUAL_WAVE_PERIOD;
+    switch(instance->wave) {
+    case VirtualWaveRamp:
+        return 2.0f * phase / VIRTUAL_WAVE_PERIOD - 1.0f;
+    case VirtualWaveNoise:
+        //Linear congruential generator, the upper 24 bits are the most random
+        instance->noise = instance->noise * 1664525UL + 1013904223UL;
+        return 2.0f * (instance->noise >> 8) / (1UL << 24) - 1.0f;
+    case VirtualWaveStep:
+        return phase < VIRTUAL_WAVE_PERIOD / 2 ? -1.0f : 1.0f;
+    default:
+        return sinf(2.0f * (float)M_PI * phase / VIRTUAL_WAVE_PERIOD);
+    }
+}
+
+SensorStatus unitemp_virtual_update(Sensor* sensor) {
+    VirtualSensor* instance = sensor->instance;
+
+    //The conversion is started on the first call and the values are read after the latency
+    if(instance->latency > 0 && !instance->converting) {
+        instance->converting = true;
+        sensor->resume_delay = instance->latency;
+        return UT_SENSORSTATUS_POLLING;
+    }
+    instance->converting = false;
+    sensor->resume_delay = 0;
+
+    uint32_t sample = instance->sample++;
+    bool fault = sample % VIRTUAL_FAULT_PERIOD == VIRTUAL_FAULT_PERIOD - 1;
+    if(instance->wave == VirtualWaveDropout && fault) return UT_SENSORSTATUS_TIMEOUT;
+    if(instance->wave == VirtualWaveBadCRC && fault) return UT_SENSORSTATUS_BADCRC;
+
+    float level = unitemp_virtual_get_level(instance, sample);
+    SensorDataType data_type = sensor->model->data_type;
+    sensor->temperature = 20.0f + 5.0f * level;
+    if(data_type == UT_DATA_TYPE_TEMP_HUM || data_type == UT_DATA_TYPE_TEMP_HUM_PRESS ||
+       data_type == UT_DATA_TYPE_TEMP_HUM_CO2) {
+        sensor->humidity = 50.0f + 20.0f * level;
+    }
+    if(data_type == UT_DATA_TYPE_TEMP_PRESS || data_type == UT_DATA_TYPE_TEMP_HUM_PRESS) {
+        sensor->pressure = 101325.0f + 1000.0f * level;
+    }
+    if(data_type == UT_DATA_TYPE_TEMP_HUM_CO2) {
+        sensor->co2 = 800.0f + 400.0f * level;
+    }
+    return UT_SENSORSTATUS_OK;
+}
+
+const char* unitemp_virtual_wave_get_name(VirtualWave wave) {
+    if(wave >= VirtualWaveCount) return "?";
+    return virtual_wave_names[wave];
+}
+
+uint8_t unitemp_virtual_latency_get_count(void) {
+    return COUNT_OF(virtual_latencies);
+}
+
+uint16_t unitemp_virtual_latency_get(uint8_t index) {
+    if(index >= COUNT_OF(virtual_latencies)) return 0;
+    return virtual_latencies[index];
+}
+
+uint8_t unitemp_virtual_latency_get_index(Sensor* sensor) {
+    VirtualSensor* instance = sensor->instance;
+    for(uint8_t i = 0; i < COUNT_OF(virtual_latencies); i++) {
+        if(virtual_latencies[i] == instance->latency) return i;
+    }
+    return 0;
+}
@@ -0,0 +1,120 @@
+/*
+    Unitemp - Universal temperature reader
+    Copyright (C) 2022-2026  Victor Nikitchuk (https://github.com/quen0n)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#ifndef UNITEMP_VIRTUAL
+#define UNITEMP_VIRTUAL
+
+#include "../unitemp.h"
+#include "../sensors.h"
+
+extern const SensorConnectionInterface unitemp_virtual;
+
+//Number of samples in one period of the periodic waveforms
+#define VIRTUAL_WAVE_PERIOD 60
+//Every n-th sample of the dropout and CRC error waveforms fails
+#define VIRTUAL_FAULT_PERIOD 10
+
+//Synthetic waveform of the virtual sensor
+typedef enum {
+    VirtualWaveSine,
+    VirtualWaveRamp,
+    VirtualWaveNoise,
+    VirtualWaveStep,
+    VirtualWaveDropout, //Sine with a missing response on every n-th sample
+    VirtualWaveBadCRC, //Sine with a checksum error on every n-th sample
+
+    VirtualWaveCount
+} VirtualWave;
+
+//Virtual sensor structure
+typedef struct {
+    //Generated waveform
+    VirtualWave wave;
+    //Conversion latency, ms
+    uint16_t latency;
+    //Number of the next sample
+    uint32_t sample;
+    //Seed of the noise, derived from the sensor name so that the sequence repeats
+    uint32_t seed;
+    //State of the noise generator
+    uint32_t noise;
+    //The conversion has been started and the values will be ready after the latency
+    bool converting;
+} VirtualSensor;
+
+/**
+ * @brief Memory allocation for the virtual sensor
+ * @param sensor Pointer to sensor
+ * @param args Arguments: waveform and conversion latency (ms)
+ * @return True if all ok
+ */
+bool unitemp_virtual_alloc(Sensor* sensor, char* args);
+
+/**
+ * @brief Freeing sensor instance memory
+ * @param sensor Pointer to sensor
+ */
+bool unitemp_virtual_free(Sensor* sensor);
+
+/**
+ * @brief Initializing the virtual sensor. The waveform starts over
+ * @param sensor Pointer to sensor
+ * @return True if initialization is successful
+ */
+bool unitemp_virtual_init(Sensor* sensor);
+
+/**
+ * @brief Deinitializing the sensor
+ * @param sensor Pointer to sensor
+ */
+bool unitemp_virtual_deinit(Sensor* sensor);
+
+/**
+ * @brief Generate the next sample of the waveform
+ * @param sensor Pointer to sensor
+ * @return Update status
+ */
+SensorStatus unitemp_virtual_update(Sensor* sensor);
+
+/**
+ * @brief Get the name of the waveform
+ * @param wave Waveform
+ * @return Pointer to the string with the name
+ */
+const char* unitemp_virtual_wave_get_name(VirtualWave wave);
+
+/**
+ * @brief Get the number of selectable conversion latencies
+ * @return Number of latencies
+ */
+uint8_t unitemp_virtual_latency_get_count(void);
+
+/**
+ * @brief Get the conversion latency by index
+ * @param index Latency index (from 0 to unitemp_virtual_latency_get_count())
+ * @return Latency, ms
+ */
+uint16_t unitemp_virtual_latency_get(uint8_t index);
+
+/**
+ * @brief Get the index of the sensor conversion latency
+ * @param sensor Pointer to sensor
+ * @return Latency index, 0 if the latency is not in the list
+ */
+uint8_t unitemp_virtual_latency_get_index(Sensor* sensor);
+
+#endif
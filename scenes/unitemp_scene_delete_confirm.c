@@ -21,6 +21,7 @@
 #include "interfaces/onewire_sensor.h"
 #include "interfaces/singlewire_sensor.h"
 #include "interfaces/spi_sensor.h"
+#include "interfaces/virtual_sensor.h"
 #include "unitemp_icons.h"
 
 void unitemp_scene_delete_confirm_on_enter(void* context) {
@@ -75,6 +76,17 @@ void unitemp_scene_delete_confirm_on_enter(void* context) {
         widget_add_text_box_element(
             app->widget, 0, 28, 128, 23, AlignLeft, AlignTop, furi_string_get_cstr(tmp), false);
     }
+    if(sensor->model->interface == &unitemp_virtual) {
+        furi_string_printf(tmp, "\e#Model:\e# %s", sensor->model->modelname);
+        widget_add_text_box_element(
+            app->widget, 0, 16, 128, 23, AlignLeft, AlignTop, furi_string_get_cstr(tmp), false);
+        furi_string_printf(
+            tmp,
+            "\e#Wave:\e# %s",
+            unitemp_virtual_wave_get_name(((VirtualSensor*)sensor->instance)->wave));
+        widget_add_text_box_element(
+            app->widget, 0, 28, 128, 23, AlignLeft, AlignTop, furi_string_get_cstr(tmp), false);
+    }
     if(sensor->model->interface == &unitemp_spi) {
         furi_string_printf(tmp, "\e#Model:\e# %s", sensor->model->modelname);
         widget_add_text_box_element(
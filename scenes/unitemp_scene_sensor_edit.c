@@ -22,6 +22,8 @@
 #include "./interfaces/onewire_sensor.h"
 #include "./interfaces/singlewire_sensor.h"
 #include "./interfaces/spi_sensor.h"
+#include "./interfaces/virtual_sensor.h"
+#include "./sensors/DS18x2x.h"
 #include "scenes/unitemp_scene.h"
 
 static bool name_edit = false;
@@ -30,13 +32,38 @@ static VariableItem* model_item;
 static VariableItem* onewire_scan_item;
 static VariableItem* gpio_pin_item;
 static VariableItem* i2c_addr_item;
+static VariableItem* i2c_mux_item;
+static VariableItem* i2c_pins_item;
+static VariableItem* alarm_high_item;
+static VariableItem* alarm_low_item;
+
+//Pin pairs (SDA, SCL) that can be selected for the I2C bus of the sensor
+#define I2C_PINS_OPTIONS_MAX 128
+static uint8_t i2c_pins_options[I2C_PINS_OPTIONS_MAX][2];
+static uint8_t i2c_pins_options_count;
+
+//Number of items in the list, the index of the next added item
+static uint8_t items_count;
+//Indexes of items that respond to clicking
+static uint8_t i2c_addr_item_index;
+static uint8_t onewire_scan_item_index;
+static uint8_t save_item_index;
+
+static VariableItem* _item_add(
+    VariableItemList* var_item_list,
+    const char* label,
+    uint8_t values_count,
+    VariableItemChangeCallback change_callback,
+    void* context) {
+    items_count++;
+    return variable_item_list_add(var_item_list, label, values_count, change_callback, context);
+}
 
 static void _onewire_scan_event_callback(void* context) {
     UnitempApp* app = context;
     OneWireSensor* ow_sensor = app->editable_sensor->instance;
-    FURI_CRITICAL_ENTER();
+    //The host masks interrupts per time slot, the search itself runs with interrupts enabled
     bool result = unitemp_onewire_scan(ow_sensor);
-    FURI_CRITICAL_EXIT();
     if(!result) {
         variable_item_set_current_value_text(onewire_scan_item, "not found");
     } else {
@@ -50,6 +77,8 @@ static void _onewire_scan_event_callback(void* context) {
         variable_item_set_current_value_text(onewire_scan_item, app->txt_buff);
         variable_item_set_current_value_text(
             model_item, unitemp_onewire_sensor_get_fc_name(app->editable_sensor));
+        //The conversion time depends on the device family
+        unitemp_ds18x2x_set_resolution(app->editable_sensor, ow_sensor->resolution);
     }
 }
 
@@ -101,25 +130,27 @@ static void _gpio_change_event_callback(void* context) {
         SingleWireSensor* instance = sensor->instance;
         unitemp_gpio_unlock(instance->data_pin);
         instance->data_pin = gpio_pin;
-        unitemp_gpio_lock(gpio_pin, interface);
+        unitemp_gpio_lock(gpio_pin, interface, sensor);
         variable_item_set_current_value_text(gpio_pin_item, instance->data_pin->name);
     } else if(interface == &unitemp_spi) {
         SPISensor* instance = sensor->instance;
         unitemp_gpio_unlock(instance->cs_pin);
-        instance->cs_pin = unitemp_gpio_get_aviable_pin(interface, index, instance->cs_pin);
-        unitemp_gpio_lock(gpio_pin, interface);
+        instance->cs_pin = gpio_pin;
+        unitemp_gpio_lock(gpio_pin, interface, sensor);
         variable_item_set_current_value_text(gpio_pin_item, instance->cs_pin->name);
     } else if(interface == &unitemp_1w) {
         OneWireSensor* instance = sensor->instance;
 
+        const SensorGpioPin* bus_pin =
+            unitemp_gpio_get_aviable_pin(interface, index, instance->bus->bus_pin);
         //removing old bus
+        unitemp_onewire_bus_remove_device(instance->bus, instance);
         unitemp_onewire_bus_free(
             instance
                 ->bus); //This making a problem for developers. The function deinitializes the port and, for example, disables UART or SWD
         //making new bus
-        const SensorGpioPin* bus_pin =
-            unitemp_gpio_get_aviable_pin(interface, index, instance->bus->bus_pin);
         instance->bus = unitemp_onewire_bus_alloc(bus_pin);
+        unitemp_onewire_bus_add_device(instance->bus, instance);
 
         variable_item_set_current_value_text(gpio_pin_item, bus_pin->name);
     }
@@ -146,6 +177,106 @@ static void _offset_change_callback(VariableItem* item) {
     variable_item_set_current_value_text(item, app->txt_buff);
 }
 
+static void _resolution_change_callback(VariableItem* item) {
+    UnitempApp* app = variable_item_get_context(item);
+    uint8_t index = variable_item_get_current_value_index(item);
+
+    //Resolution from 9 to 12 bits
+    unitemp_ds18x2x_set_resolution(app->editable_sensor, index + 9);
+    snprintf(app->txt_buff, TEXT_STORE_SIZE, "%d bit", index + 9);
+    variable_item_set_current_value_text(item, app->txt_buff);
+}
+
+/**
+ * @brief Show the alarm limits of the 1-Wire sensor
+ * 
+ * The alarm search filters only the probes whose reading is within the limits. If the last
+ * reading is outside them, the probe is read on every cycle and the limits are marked with "!".
+ * @param app Pointer to the application
+ */
+static void _alarm_limits_show(UnitempApp* app) {
+    Sensor* sensor = app->editable_sensor;
+    OneWireSensor* ow_sensor = sensor->instance;
+    const char* mark = "";
+    if(sensor->status == UT_SENSORSTATUS_OK) {
+        //The device compares the reading without the user offset
+        float temperature = sensor->temperature - sensor->temperature_offset / 10.f;
+        if(temperature <= ow_sensor->alarm_low || temperature >= ow_sensor->alarm_high) {
+            mark = " !";
+        }
+    }
+    snprintf(app->txt_buff, TEXT_STORE_SIZE, "%d%s", ow_sensor->alarm_high, mark);
+    variable_item_set_current_value_text(alarm_high_item, app->txt_buff);
+    snprintf(app->txt_buff, TEXT_STORE_SIZE, "%d%s", ow_sensor->alarm_low, mark);
+    variable_item_set_current_value_text(alarm_low_item, app->txt_buff);
+}
+
+static void _alarm_high_change_callback(VariableItem* item) {
+    UnitempApp* app = variable_item_get_context(item);
+    OneWireSensor* ow_sensor = app->editable_sensor->instance;
+
+    ow_sensor->alarm_high = variable_item_get_current_value_index(item) + DS18X2X_ALARM_MIN;
+    //The lower limit follows the upper one down
+    if(ow_sensor->alarm_low > ow_sensor->alarm_high) {
+        ow_sensor->alarm_low = ow_sensor->alarm_high;
+        variable_item_set_current_value_index(
+            alarm_low_item, ow_sensor->alarm_low - DS18X2X_ALARM_MIN);
+    }
+    _alarm_limits_show(app);
+}
+
+static void _alarm_low_change_callback(VariableItem* item) {
+    UnitempApp* app = variable_item_get_context(item);
+    OneWireSensor* ow_sensor = app->editable_sensor->instance;
+
+    ow_sensor->alarm_low = variable_item_get_current_value_index(item) + DS18X2X_ALARM_MIN;
+    //The upper limit follows the lower one up
+    if(ow_sensor->alarm_high < ow_sensor->alarm_low) {
+        ow_sensor->alarm_high = ow_sensor->alarm_low;
+        variable_item_set_current_value_index(
+            alarm_high_item, ow_sensor->alarm_high - DS18X2X_ALARM_MIN);
+    }
+    _alarm_limits_show(app);
+}
+
+static void _spi_clock_change_callback(VariableItem* item) {
+    UnitempApp* app = variable_item_get_context(item);
+    SPISensor* spi_sensor = app->editable_sensor->instance;
+
+    spi_sensor->clock = variable_item_get_current_value_index(item);
+    variable_item_set_current_value_text(item, unitemp_spi_clock_get_name(spi_sensor->clock));
+}
+
+static void _fast_capture_change_callback(VariableItem* item) {
+    UnitempApp* app = variable_item_get_context(item);
+    uint8_t index = variable_item_get_current_value_index(item);
+
+    if(!unitemp_spi_sensor_set_fast_capture(app->editable_sensor, index == 1)) {
+        index = 0;
+        variable_item_set_current_value_index(item, index);
+    }
+    variable_item_set_current_value_text(item, index == 1 ? "On" : "Off");
+}
+
+static void _virtual_wave_change_callback(VariableItem* item) {
+    UnitempApp* app = variable_item_get_context(item);
+    VirtualSensor* virtual_sensor = app->editable_sensor->instance;
+
+    virtual_sensor->wave = variable_item_get_current_value_index(item);
+    variable_item_set_current_value_text(
+        item, unitemp_virtual_wave_get_name(virtual_sensor->wave));
+}
+
+static void _virtual_latency_change_callback(VariableItem* item) {
+    UnitempApp* app = variable_item_get_context(item);
+    VirtualSensor* virtual_sensor = app->editable_sensor->instance;
+
+    virtual_sensor->latency =
+        unitemp_virtual_latency_get(variable_item_get_current_value_index(item));
+    snprintf(app->txt_buff, TEXT_STORE_SIZE, "%d ms", virtual_sensor->latency);
+    variable_item_set_current_value_text(item, app->txt_buff);
+}
+
 static void _gpio_change_callback(VariableItem* item) {
     UnitempApp* app = variable_item_get_context(item);
     view_dispatcher_send_custom_event(app->view_dispatcher, CustomEventGPIOChanged);
@@ -163,6 +294,92 @@ static void _i2c_addr_change_callback(VariableItem* item) {
     view_dispatcher_send_custom_event(app->view_dispatcher, CustomEventI2CScan);
 }
 
+static void _i2c_mux_text_update(UnitempApp* app, I2CSensor* i2c_sensor) {
+    if(i2c_sensor->mux_i2c_adress == 0) {
+        variable_item_set_current_value_text(i2c_mux_item, "None");
+        return;
+    }
+    snprintf(
+        app->txt_buff,
+        TEXT_STORE_SIZE,
+        "0x%02X ch%d",
+        i2c_sensor->mux_i2c_adress >> 1,
+        i2c_sensor->mux_channel);
+    variable_item_set_current_value_text(i2c_mux_item, app->txt_buff);
+}
+
+static void _i2c_mux_change_callback(VariableItem* item) {
+    UnitempApp* app = variable_item_get_context(item);
+    I2CSensor* i2c_sensor = app->editable_sensor->instance;
+    uint8_t index = variable_item_get_current_value_index(item);
+
+    //0 - direct connection, then all channels of all multiplexers
+    if(index == 0) {
+        i2c_sensor->mux_i2c_adress = 0;
+        i2c_sensor->mux_channel = 0;
+    } else {
+        i2c_sensor->mux_i2c_adress =
+            UNITEMP_I2C_MUX_MIN_ADRESS + ((index - 1) / UNITEMP_I2C_MUX_CHANNELS) * 2;
+        i2c_sensor->mux_channel = (index - 1) % UNITEMP_I2C_MUX_CHANNELS;
+    }
+    _i2c_mux_text_update(app, i2c_sensor);
+}
+
+static void _i2c_pins_option_add(uint8_t sda_num, uint8_t scl_num) {
+    if(i2c_pins_options_count >= I2C_PINS_OPTIONS_MAX) return;
+    for(uint8_t i = 0; i < i2c_pins_options_count; i++) {
+        if(i2c_pins_options[i][0] == sda_num && i2c_pins_options[i][1] == scl_num) return;
+    }
+    i2c_pins_options[i2c_pins_options_count][0] = sda_num;
+    i2c_pins_options[i2c_pins_options_count][1] = scl_num;
+    i2c_pins_options_count++;
+}
+
+static void _i2c_pins_options_fill(I2CSensor* i2c_sensor) {
+    i2c_pins_options_count = 0;
+    //Main bus
+    if(i2c_sensor->soft_bus == NULL || unitemp_i2c_main_bus_is_aviable()) {
+        _i2c_pins_option_add(UNITEMP_I2C_MAIN_SDA_PIN, UNITEMP_I2C_MAIN_SCL_PIN);
+    }
+    //Existing software buses
+    for(uint8_t i = 0; i < UNITEMP_I2C_SOFT_BUSES_MAX; i++) {
+        UnitempI2CSoftBus* bus = unitemp_i2c_soft_bus_get(i);
+        if(bus != NULL) _i2c_pins_option_add(bus->sda_pin->num, bus->scl_pin->num);
+    }
+    //New software bus on any two free pins
+    for(uint8_t i = 0; i < unitemp_gpio_get_count(); i++) {
+        const SensorGpioPin* sda_pin = unitemp_gpio_get_from_index(i);
+        if(!unitemp_i2c_soft_pin_is_aviable(sda_pin)) continue;
+        for(uint8_t j = 0; j < unitemp_gpio_get_count(); j++) {
+            const SensorGpioPin* scl_pin = unitemp_gpio_get_from_index(j);
+            if(i == j || !unitemp_i2c_soft_pin_is_aviable(scl_pin)) continue;
+            _i2c_pins_option_add(sda_pin->num, scl_pin->num);
+        }
+    }
+}
+
+static void _i2c_pins_text_update(UnitempApp* app, I2CSensor* i2c_sensor) {
+    snprintf(
+        app->txt_buff,
+        TEXT_STORE_SIZE,
+        "%d/%d",
+        unitemp_i2c_get_sda_pin(i2c_sensor)->num,
+        unitemp_i2c_get_scl_pin(i2c_sensor)->num);
+    variable_item_set_current_value_text(i2c_pins_item, app->txt_buff);
+}
+
+static void _i2c_pins_change_callback(VariableItem* item) {
+    UnitempApp* app = variable_item_get_context(item);
+    I2CSensor* i2c_sensor = app->editable_sensor->instance;
+    uint8_t index = variable_item_get_current_value_index(item);
+
+    unitemp_i2c_sensor_set_bus(
+        i2c_sensor,
+        unitemp_gpio_get_from_int(i2c_pins_options[index][0]),
+        unitemp_gpio_get_from_int(i2c_pins_options[index][1]));
+    _i2c_pins_text_update(app, i2c_sensor);
+}
+
 static void _enter_callback(void* context, uint32_t index) {
     UnitempApp* app = context;
     const SensorConnectionInterface* sensor_interface = app->editable_sensor->model->interface;
@@ -173,17 +390,16 @@ static void _enter_callback(void* context, uint32_t index) {
     }
 
     //1W sensors scan
-    if(index == 3 && sensor_interface == &unitemp_1w) {
+    if(index == onewire_scan_item_index && sensor_interface == &unitemp_1w) {
         view_dispatcher_send_custom_event(app->view_dispatcher, CustomEventOneWireScan);
     }
     //I2C sensors scan
-    if(index == 2 && sensor_interface == &unitemp_i2c) {
+    if(index == i2c_addr_item_index && sensor_interface == &unitemp_i2c) {
         view_dispatcher_send_custom_event(app->view_dispatcher, CustomEventI2CScan);
     }
 
     //Save
-    if((index == 4 && sensor_interface != &unitemp_1w) ||
-       (index == 5 && sensor_interface == &unitemp_1w)) {
+    if(index == save_item_index) {
         //Exit if the one wire sensor does not have an ID
         if(sensor_interface == &unitemp_1w &&
            ((OneWireSensor*)(app->editable_sensor->instance))->family_code == 0) {
@@ -212,6 +428,10 @@ void unitemp_scene_sensor_edit_on_enter(void* context) {
 
     name_edit = false;
     i2c_addr = 0;
+    items_count = 0;
+    i2c_addr_item_index = UINT8_MAX;
+    onewire_scan_item_index = UINT8_MAX;
+    save_item_index = UINT8_MAX;
 
     Sensor* sensor = app->editable_sensor;
     if(sensor == NULL) {
@@ -224,13 +444,13 @@ void unitemp_scene_sensor_edit_on_enter(void* context) {
     unitemp_sensor_deinit(sensor);
 
     //Sensor name
-    item = variable_item_list_add(
+    item = _item_add(
         var_item_list, "Name", strlen(sensor->name) > 7 ? 1 : 2, _name_change_callback, app);
     variable_item_set_current_value_index(item, 0);
     variable_item_set_current_value_text(item, sensor->name);
 
     //Sensor model (not editable)
-    model_item = variable_item_list_add(var_item_list, "Model", 1, NULL, NULL);
+    model_item = _item_add(var_item_list, "Model", 1, NULL, NULL);
     variable_item_set_current_value_index(model_item, 0);
     variable_item_set_current_value_text(
         model_item,
@@ -239,7 +459,8 @@ void unitemp_scene_sensor_edit_on_enter(void* context) {
 
     //Device address on the I2C bus (for I2C sensors)
     if(sensor->model->interface == &unitemp_i2c) {
-        i2c_addr_item = variable_item_list_add(
+        i2c_addr_item_index = items_count;
+        i2c_addr_item = _item_add(
             var_item_list,
             "I2C address",
             (((I2CSensor*)sensor->instance)->max_i2c_adress >> 1) -
@@ -259,6 +480,39 @@ void unitemp_scene_sensor_edit_on_enter(void* context) {
             variable_item_set_current_value_text(i2c_addr_item, "Scan");
             variable_item_set_current_value_index(i2c_addr_item, 0);
         }
+
+        //Multiplexer channel
+        I2CSensor* i2c_sensor = sensor->instance;
+        i2c_mux_item = _item_add(
+            var_item_list,
+            "I2C mux",
+            1 + UNITEMP_I2C_MUX_COUNT * UNITEMP_I2C_MUX_CHANNELS,
+            _i2c_mux_change_callback,
+            app);
+        if(i2c_sensor->mux_i2c_adress == 0) {
+            variable_item_set_current_value_index(i2c_mux_item, 0);
+        } else {
+            variable_item_set_current_value_index(
+                i2c_mux_item,
+                1 +
+                    ((i2c_sensor->mux_i2c_adress - UNITEMP_I2C_MUX_MIN_ADRESS) / 2) *
+                        UNITEMP_I2C_MUX_CHANNELS +
+                    i2c_sensor->mux_channel);
+        }
+        _i2c_mux_text_update(app, i2c_sensor);
+
+        //Bus pins: 15/16 - main bus, any other pair - software bus
+        _i2c_pins_options_fill(i2c_sensor);
+        i2c_pins_item = _item_add(
+            var_item_list, "SDA/SCL", i2c_pins_options_count, _i2c_pins_change_callback, app);
+        for(uint8_t i = 0; i < i2c_pins_options_count; i++) {
+            if(i2c_pins_options[i][0] == unitemp_i2c_get_sda_pin(i2c_sensor)->num &&
+               i2c_pins_options[i][1] == unitemp_i2c_get_scl_pin(i2c_sensor)->num) {
+                variable_item_set_current_value_index(i2c_pins_item, i);
+                break;
+            }
+        }
+        _i2c_pins_text_update(app, i2c_sensor);
     }
     //Sensor connection port (for one wire, SPI and single wire)
     if(sensor->model->interface == &unitemp_1w ||
@@ -276,7 +530,7 @@ void unitemp_scene_sensor_edit_on_enter(void* context) {
         uint8_t aviable_gpio_count =
             unitemp_gpio_get_aviable_pin_count(sensor->model->interface, gpio_pin);
         UNITEMP_DEBUG("aviable %d values", aviable_gpio_count);
-        gpio_pin_item = variable_item_list_add(
+        gpio_pin_item = _item_add(
             var_item_list,
             sensor->model->interface == &unitemp_spi ? "CS pin" : "Data pin",
             aviable_gpio_count,
@@ -296,8 +550,9 @@ void unitemp_scene_sensor_edit_on_enter(void* context) {
 
     // Device address on the one wire bus (for one wire sensors)
     if(sensor->model->interface == &unitemp_1w) {
-        onewire_scan_item = variable_item_list_add(
-            var_item_list, "Device ID", 2, _onwire_addr_change_callback, app);
+        onewire_scan_item_index = items_count;
+        onewire_scan_item =
+            _item_add(var_item_list, "Device ID", 2, _onwire_addr_change_callback, app);
         OneWireSensor* ow_sensor = sensor->instance;
         if(ow_sensor->family_code == 0) {
             variable_item_set_current_value_text(onewire_scan_item, "Scan");
@@ -311,10 +566,62 @@ void unitemp_scene_sensor_edit_on_enter(void* context) {
                 ow_sensor->deviceID[3]);
             variable_item_set_current_value_text(onewire_scan_item, app->txt_buff);
         }
+
+        item = _item_add(var_item_list, "Resolution", 4, _resolution_change_callback, app);
+        variable_item_set_current_value_index(item, ow_sensor->resolution - 9);
+        snprintf(app->txt_buff, TEXT_STORE_SIZE, "%d bit", ow_sensor->resolution);
+        variable_item_set_current_value_text(item, app->txt_buff);
+
+        //Alarm limits for the alarm search mode
+        const uint8_t alarm_values = DS18X2X_ALARM_MAX - DS18X2X_ALARM_MIN + 1;
+        alarm_high_item = _item_add(
+            var_item_list, "Alarm high", alarm_values, _alarm_high_change_callback, app);
+        variable_item_set_current_value_index(
+            alarm_high_item, ow_sensor->alarm_high - DS18X2X_ALARM_MIN);
+        alarm_low_item = _item_add(
+            var_item_list, "Alarm low", alarm_values, _alarm_low_change_callback, app);
+        variable_item_set_current_value_index(
+            alarm_low_item, ow_sensor->alarm_low - DS18X2X_ALARM_MIN);
+        _alarm_limits_show(app);
+    }
+
+    //Bus clock and fast capture (for SPI sensors)
+    if(sensor->model->interface == &unitemp_spi) {
+        SPISensor* spi_sensor = sensor->instance;
+        item = _item_add(
+            var_item_list, "SPI clock", UnitempSPIClockCount, _spi_clock_change_callback, app);
+        variable_item_set_current_value_index(item, spi_sensor->clock);
+        variable_item_set_current_value_text(item, unitemp_spi_clock_get_name(spi_sensor->clock));
+
+        if(spi_sensor->conversion_time > 0) {
+            item = _item_add(var_item_list, "Fast capture", 2, _fast_capture_change_callback, app);
+            variable_item_set_current_value_index(item, spi_sensor->capture != NULL);
+            variable_item_set_current_value_text(item, spi_sensor->capture != NULL ? "On" : "Off");
+        }
+    }
+
+    //Waveform and conversion latency (for virtual sensors)
+    if(sensor->model->interface == &unitemp_virtual) {
+        VirtualSensor* virtual_sensor = sensor->instance;
+        item = _item_add(
+            var_item_list, "Waveform", VirtualWaveCount, _virtual_wave_change_callback, app);
+        variable_item_set_current_value_index(item, virtual_sensor->wave);
+        variable_item_set_current_value_text(
+            item, unitemp_virtual_wave_get_name(virtual_sensor->wave));
+
+        item = _item_add(
+            var_item_list,
+            "Latency",
+            unitemp_virtual_latency_get_count(),
+            _virtual_latency_change_callback,
+            app);
+        variable_item_set_current_value_index(item, unitemp_virtual_latency_get_index(sensor));
+        snprintf(app->txt_buff, TEXT_STORE_SIZE, "%d ms", virtual_sensor->latency);
+        variable_item_set_current_value_text(item, app->txt_buff);
     }
 
     //Temperature offset
-    item = variable_item_list_add(var_item_list, "Temp. offset", 41, _offset_change_callback, app);
+    item = _item_add(var_item_list, "Temp. offset", 41, _offset_change_callback, app);
     variable_item_set_current_value_index(item, sensor->temperature_offset + 20);
 
     snprintf(
@@ -325,7 +632,8 @@ void unitemp_scene_sensor_edit_on_enter(void* context) {
     variable_item_set_current_value_text(item, app->txt_buff);
 
     if(!unitemp_sensor_in_list(sensor)) {
-        variable_item_list_add(var_item_list, "Save", 1, NULL, NULL);
+        save_item_index = items_count;
+        _item_add(var_item_list, "Save", 1, NULL, NULL);
     }
 
     view_dispatcher_switch_to_view(app->view_dispatcher, UnitempViewVariableList);
@@ -26,6 +26,22 @@
 #include "./interfaces/onewire_sensor.h"
 #include "./interfaces/singlewire_sensor.h"
 #include "./interfaces/spi_sensor.h"
+#include "./interfaces/virtual_sensor.h"
+
+//Longest sensor name
+#define SENSOR_NAME_MAX_LEN 10
+
+/**
+ * @brief Check if the name is taken by one of the sensors
+ * @param name Sensor name
+ * @return True if a sensor with this name exists
+ */
+static bool _sensor_name_is_used(const char* name) {
+    for(uint8_t i = 0; i < unitemp_sensors_get_count(); i++) {
+        if(strcmp(unitemp_sensors_get(i)->name, name) == 0) return true;
+    }
+    return false;
+}
 
 void unitemp_scene_sensors_list_on_enter(void* context) {
     UnitempApp* app = context;
@@ -62,7 +78,8 @@ bool unitemp_scene_sensors_list_on_event(void* context, SceneManagerEvent event)
         const SensorModel* model = unitemp_sensors_models_get()[event.event];
         do {
             //Checking Sensor Availability
-            if(unitemp_gpio_get_aviable_pin(model->interface, 0, NULL) == NULL) {
+            if(model->interface != &unitemp_virtual &&
+               unitemp_gpio_get_aviable_pin(model->interface, 0, NULL) == NULL) {
                 DialogMessage* message = dialog_message_alloc();
                 dialog_message_set_icon(
                     message,
@@ -81,16 +98,29 @@ bool unitemp_scene_sensors_list_on_event(void* context, SceneManagerEvent event)
                         AlignCenter,
                         AlignCenter);
                     UNITEMP_DEBUG("Unable to add a sensor. All GPIOs are busy");
+                } else if(unitemp_gpio_get_conflict(
+                              model->interface, app->txt_buff, TEXT_STORE_SIZE)) {
+                    //The bus pin and the sensor that occupies it
+                    dialog_message_set_text(
+                        message,
+                        app->txt_buff,
+                        (128 - icon_get_width(&I_confused_dolph_43x31)) / 2 +
+                            icon_get_width(&I_confused_dolph_43x31),
+                        36,
+                        AlignCenter,
+                        AlignCenter);
+                    UNITEMP_DEBUG("Unable to add a sensor. %s", app->txt_buff);
                 } else if(model->interface == &unitemp_i2c) {
                     dialog_message_set_text(
                         message,
-                        "GPIO's 15 or 16\nare busy",
+                        "GPIO's 15 or 16\nare busy and no\nfree pins left",
                         (128 - icon_get_width(&I_confused_dolph_43x31)) / 2 +
                             icon_get_width(&I_confused_dolph_43x31),
                         36,
                         AlignCenter,
                         AlignCenter);
-                    UNITEMP_DEBUG("Unable to add a sensor. GPIOs 15 or 16 are busy");
+                    UNITEMP_DEBUG(
+                        "Unable to add a sensor. GPIOs 15 or 16 are busy and there are no free pins for software bus");
                 } else if(model->interface == &unitemp_spi) {
                     dialog_message_set_text(
                         message,
@@ -118,18 +148,29 @@ bool unitemp_scene_sensors_list_on_event(void* context, SceneManagerEvent event)
                 }
             }
             //Allocating memory for a name
-            char* name = malloc(11);
+            char* name = malloc(SENSOR_NAME_MAX_LEN + 1);
             if(name == NULL) {
                 FURI_LOG_E(APP_NAME, "Sensor %s name allocation error", model->modelname);
                 break;
             }
-            //Adding a counter to the name if such a sensor exists
-            if(sensor_current_model_count == 0)
-                snprintf(name, 11, "%s%c", model->modelname, 0);
-            else
-                snprintf(name, 11, "%s_%d%c", model->modelname, sensor_current_model_count, 0);
+            //Adding a counter to the name if such a sensor exists. The model name is shortened
+            //so that the counter fits, the names already in use are skipped
+            uint16_t number = sensor_current_model_count;
+            do {
+                char suffix[7] = {0};
+                if(number > 0) snprintf(suffix, sizeof(suffix), "_%u", number);
+                snprintf(
+                    name,
+                    SENSOR_NAME_MAX_LEN + 1,
+                    "%.*s%s",
+                    (int)(SENSOR_NAME_MAX_LEN - strlen(suffix)),
+                    model->modelname,
+                    suffix);
+                number++;
+            } while(_sensor_name_is_used(name));
 
             char* args = malloc(21);
+            args[0] = '\0';
             //Selecting the first available port for single wire and SPI sensor
             if(model->interface == &unitemp_singlewire || model->interface == &unitemp_spi) {
                 snprintf(
@@ -152,6 +193,7 @@ bool unitemp_scene_sensors_list_on_event(void* context, SceneManagerEvent event)
                     0);
             }
             //For I2C the address will be selected automatically
+            //Virtual sensors start with a sine without latency
 
             app->editable_sensor = unitemp_sensor_alloc(name, model, args);
             free(name);
@@ -17,6 +17,8 @@
 */
 
 #include "../unitemp.h"
+#include "../interfaces/onewire_sensor.h"
+#include "../sensors/MAX31855.h"
 
 static const char unitemp_scene_settings_backlight_text[2][9] = {"System", "Infinity"};
 static const char unitemp_scene_settings_temperature_units_text[UT_TEMP_COUNT][3] = {"*C", "*F"};
@@ -26,6 +28,8 @@ static const char unitemp_scene_settings_humidity_units_text[UT_HUMIDITY_COUNT][
 static const char unitemp_scene_settings_pressure_units_text[UT_PRESSURE_COUNT][5] =
     {"mmHg", "inHg", "kPa", "hPa"};
 static const char unitemp_scene_settings_off_on_text[2][4] = {"OFF", "ON"};
+static const char unitemp_scene_settings_bus_trace_text[UnitempTraceModesCount][7] =
+    {"OFF", "Record", "Replay"};
 
 static void unitemp_scene_settings_backlight_change_callback(VariableItem* item) {
     UnitempApp* app = variable_item_get_context(item);
@@ -102,6 +106,57 @@ static void unitemp_scene_settings_otg_auto_on_change_callback(VariableItem* ite
     app->settings->otg_auto_on = (bool)index;
     UNITEMP_DEBUG("5V auto on set to %s", unitemp_scene_settings_off_on_text[index]);
 }
+static void unitemp_scene_settings_i2c_pipelining_change_callback(VariableItem* item) {
+    UnitempApp* app = variable_item_get_context(item);
+    const uint8_t index = variable_item_get_current_value_index(item);
+
+    variable_item_set_current_value_text(item, unitemp_scene_settings_off_on_text[index]);
+    app->settings->i2c_pipelining = (bool)index;
+    UNITEMP_DEBUG("I2C pipelining set to %s", unitemp_scene_settings_off_on_text[index]);
+}
+static void unitemp_scene_settings_onewire_alarm_search_change_callback(VariableItem* item) {
+    UnitempApp* app = variable_item_get_context(item);
+    const uint8_t index = variable_item_get_current_value_index(item);
+
+    variable_item_set_current_value_text(item, unitemp_scene_settings_off_on_text[index]);
+    app->settings->onewire_alarm_search = (bool)index;
+    unitemp_onewire_set_alarm_search(app->settings->onewire_alarm_search);
+    UNITEMP_DEBUG("1-Wire alarm search set to %s", unitemp_scene_settings_off_on_text[index]);
+}
+static void unitemp_scene_settings_onewire_overdrive_change_callback(VariableItem* item) {
+    UnitempApp* app = variable_item_get_context(item);
+    const uint8_t index = variable_item_get_current_value_index(item);
+
+    variable_item_set_current_value_text(item, unitemp_scene_settings_off_on_text[index]);
+    app->settings->onewire_overdrive = (bool)index;
+    unitemp_onewire_set_overdrive(app->settings->onewire_overdrive);
+    UNITEMP_DEBUG("1-Wire overdrive set to %s", unitemp_scene_settings_off_on_text[index]);
+}
+static void unitemp_scene_settings_singlewire_group_change_callback(VariableItem* item) {
+    UnitempApp* app = variable_item_get_context(item);
+    const uint8_t index = variable_item_get_current_value_index(item);
+
+    variable_item_set_current_value_text(item, unitemp_scene_settings_off_on_text[index]);
+    app->settings->singlewire_group = (bool)index;
+    UNITEMP_DEBUG("DHT group read set to %s", unitemp_scene_settings_off_on_text[index]);
+}
+static void unitemp_scene_settings_thermocouple_nist_change_callback(VariableItem* item) {
+    UnitempApp* app = variable_item_get_context(item);
+    const uint8_t index = variable_item_get_current_value_index(item);
+
+    variable_item_set_current_value_text(item, unitemp_scene_settings_off_on_text[index]);
+    app->settings->thermocouple_nist = (bool)index;
+    unitemp_MAX31855_set_linearization(app->settings->thermocouple_nist);
+    UNITEMP_DEBUG("TC NIST curve set to %s", unitemp_scene_settings_off_on_text[index]);
+}
+static void unitemp_scene_settings_bus_trace_change_callback(VariableItem* item) {
+    UnitempApp* app = variable_item_get_context(item);
+    const uint8_t index = variable_item_get_current_value_index(item);
+
+    variable_item_set_current_value_text(item, unitemp_scene_settings_bus_trace_text[index]);
+    app->settings->bus_trace = index;
+    UNITEMP_DEBUG("Bus trace set to %s", unitemp_scene_settings_bus_trace_text[index]);
+}
 
 void unitemp_scene_settings_on_enter(void* context) {
     UnitempApp* app = context;
@@ -193,6 +248,66 @@ void unitemp_scene_settings_on_enter(void* context) {
     variable_item_set_current_value_index(item, value_index);
     variable_item_set_current_value_text(item, unitemp_scene_settings_off_on_text[value_index]);
 
+    item = variable_item_list_add(
+        var_item_list,
+        "I2C pipelining",
+        COUNT_OF(unitemp_scene_settings_off_on_text),
+        unitemp_scene_settings_i2c_pipelining_change_callback,
+        app);
+    value_index = app->settings->i2c_pipelining;
+    variable_item_set_current_value_index(item, value_index);
+    variable_item_set_current_value_text(item, unitemp_scene_settings_off_on_text[value_index]);
+
+    item = variable_item_list_add(
+        var_item_list,
+        "1W alarm search",
+        COUNT_OF(unitemp_scene_settings_off_on_text),
+        unitemp_scene_settings_onewire_alarm_search_change_callback,
+        app);
+    value_index = app->settings->onewire_alarm_search;
+    variable_item_set_current_value_index(item, value_index);
+    variable_item_set_current_value_text(item, unitemp_scene_settings_off_on_text[value_index]);
+
+    item = variable_item_list_add(
+        var_item_list,
+        "1W overdrive",
+        COUNT_OF(unitemp_scene_settings_off_on_text),
+        unitemp_scene_settings_onewire_overdrive_change_callback,
+        app);
+    value_index = app->settings->onewire_overdrive;
+    variable_item_set_current_value_index(item, value_index);
+    variable_item_set_current_value_text(item, unitemp_scene_settings_off_on_text[value_index]);
+
+    item = variable_item_list_add(
+        var_item_list,
+        "DHT group read",
+        COUNT_OF(unitemp_scene_settings_off_on_text),
+        unitemp_scene_settings_singlewire_group_change_callback,
+        app);
+    value_index = app->settings->singlewire_group;
+    variable_item_set_current_value_index(item, value_index);
+    variable_item_set_current_value_text(item, unitemp_scene_settings_off_on_text[value_index]);
+
+    item = variable_item_list_add(
+        var_item_list,
+        "TC NIST curve",
+        COUNT_OF(unitemp_scene_settings_off_on_text),
+        unitemp_scene_settings_thermocouple_nist_change_callback,
+        app);
+    value_index = app->settings->thermocouple_nist;
+    variable_item_set_current_value_index(item, value_index);
+    variable_item_set_current_value_text(item, unitemp_scene_settings_off_on_text[value_index]);
+
+    item = variable_item_list_add(
+        var_item_list,
+        "Bus trace",
+        COUNT_OF(unitemp_scene_settings_bus_trace_text),
+        unitemp_scene_settings_bus_trace_change_callback,
+        app);
+    value_index = app->settings->bus_trace;
+    variable_item_set_current_value_index(item, value_index);
+    variable_item_set_current_value_text(item, unitemp_scene_settings_bus_trace_text[value_index]);
+
     variable_item_list_set_selected_item(app->var_item_list, 0);
 
     view_dispatcher_switch_to_view(app->view_dispatcher, UnitempViewVariableList);
@@ -213,4 +328,15 @@ void unitemp_scene_settings_on_exit(void* context) {
     variable_item_list_reset(app->var_item_list);
     variable_item_list_set_selected_item(app->var_item_list, 0);
     unitemp_settings_save(app);
+
+    //The sensors are restarted so that the trace also covers their initialization
+    if(app->settings->bus_trace != unitemp_trace_get_mode()) {
+        unitemp_sensors_deinit(app);
+        unitemp_trace_set_mode(app->settings->bus_trace);
+        //A new recording is not mixed with the old one
+        if(app->settings->bus_trace == UnitempTraceModeRecord) {
+            unitemp_trace_clear(app->storage);
+        }
+        unitemp_sensors_init(app);
+    }
 }
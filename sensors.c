@@ -5,6 +5,7 @@
 #include "./interfaces/onewire_sensor.h"
 #include "./interfaces/singlewire_sensor.h"
 #include "./interfaces/spi_sensor.h"
+#include "./interfaces/virtual_sensor.h"
 
 #include "sensors/DHTxx.h"
 #include "sensors/AM2320.h"
@@ -26,6 +27,7 @@
 #include "./sensors/SCD4x.h"
 #include "./sensors/TMP102.h"
 #include "./sensors/SHTC3.h"
+#include "./sensors/Virtual.h"
 
 #define DISPLAY_UPDATE_PERIOD_MS 250UL
 #define APP_SENSORS_FILENAME     "sensors.list"
@@ -33,6 +35,17 @@
 static Sensor** sensors_list = NULL;
 //Number of loaded sensors
 static uint8_t sensors_count = 0;
+//Indexes of sensors in the order of polling
+static uint8_t sensors_poll_order[UINT8_MAX];
+//Sensors polled in one pipelined cycle and their statuses
+static Sensor* sensors_pipeline[UINT8_MAX];
+static SensorStatus sensors_pipeline_status[UINT8_MAX];
+//Single-wire sensors whose frames are captured together in the current polling cycle
+static Sensor* sensors_singlewire[SINGLEWIRE_SENSORS_MAX];
+static SensorStatus sensors_singlewire_status[SINGLEWIRE_SENSORS_MAX];
+//SPI sensors read in one bus acquisition
+static Sensor* sensors_spi[SPI_SENSORS_MAX];
+static SensorStatus sensors_spi_status[SPI_SENSORS_MAX];
 
 //List of sensor models
 static const SensorModel* sensor_model_list[] = {
@@ -64,7 +77,12 @@ static const SensorModel* sensor_model_list[] = {
     &SHTC3, //tested
     &SI7021, //tested
     &TMP102, //tested
-
+    //Synthetic data for testing without hardware
+    &VirtT,
+    &VirtTH,
+    &VirtTP,
+    &VirtTHP,
+    &VirtCO2,
 };
 //Number of sensor models
 #define SENSOR_MODELS_COUNT (int)(sizeof(sensor_model_list) / sizeof(const SensorModel*))
@@ -101,6 +119,8 @@ Sensor* unitemp_sensor_alloc(char* name, const SensorModel* model, char* args) {
     sensor->humidity = -128.0f;
     sensor->pressure = -128.0f;
     sensor->temperature_offset = 0;
+    sensor->polling_interval = model->polling_interval;
+    sensor->resume_delay = 0;
     //Memory allocation for a sensor instance depending on its interface
     status = sensor->model->interface->allocator(sensor, args);
 
@@ -210,39 +230,70 @@ bool unitemp_sensor_deinit(Sensor* sensor) {
     return result;
 }
 
-SensorStatus unitemp_sensor_update(Sensor* sensor, void* context) {
-    if(sensor == NULL || context == NULL) {
-        return UT_SENSORSTATUS_ERROR;
+/**
+ * @brief Get the time between the sensor polls
+ * @param sensor Pointer to sensor
+ * @return Time in ms. Unfinished polls are continued after the delay requested by the driver
+ */
+static uint32_t unitemp_sensor_get_interval(Sensor* sensor) {
+    if(sensor->status == UT_SENSORSTATUS_POLLING && sensor->resume_delay > 0) {
+        return sensor->resume_delay;
     }
+    return sensor->polling_interval;
+}
+
+/**
+ * @brief Prepare the sensor for polling
+ * 
+ * Checks the polling interval, initializes the sensor and turns on 5V if needed
+ * @param sensor Pointer to sensor
+ * @param app Pointer to application
+ * @param status Pointer to the status returned when the sensor must not be polled now
+ * @return True if the sensor values must be updated now
+ */
+static bool unitemp_sensor_update_prepare(Sensor* sensor, UnitempApp* app, SensorStatus* status) {
     if(sensor->status == UT_SENSORSTATUS_INACTIVE) {
-        return UT_SENSORSTATUS_INACTIVE;
+        *status = UT_SENSORSTATUS_INACTIVE;
+        return false;
     }
 
-    UnitempApp* app = context;
-
     //Checking the validity of the sensor polling
-    if(furi_get_tick() - sensor->last_polling_time < sensor->model->polling_interval) {
+    if(furi_get_tick() - sensor->last_polling_time < unitemp_sensor_get_interval(sensor)) {
         //Return an error if the last sensor poll was unsuccessful
         if(sensor->status == UT_SENSORSTATUS_TIMEOUT) {
-            return UT_SENSORSTATUS_TIMEOUT;
+            *status = UT_SENSORSTATUS_TIMEOUT;
+        } else {
+            *status = UT_SENSORSTATUS_EARLYPOOL;
         }
-        return UT_SENSORSTATUS_EARLYPOOL;
+        return false;
+    }
+    //The interval is counted from the start of the poll, continuing it does not shift it
+    if(sensor->status != UT_SENSORSTATUS_POLLING || sensor->resume_delay == 0) {
+        sensor->last_polling_time = furi_get_tick();
     }
-    sensor->last_polling_time = furi_get_tick();
 
     if(sensor->status == UT_SENSORSTATUS_UNINITIALIZED) {
         UNITEMP_DEBUG("Attempting to initialize the sensor %s", sensor->name);
         if(!unitemp_sensor_init(sensor)) {
-            return UT_SENSORSTATUS_UNINITIALIZED;
+            *status = UT_SENSORSTATUS_UNINITIALIZED;
+            return false;
         }
     }
 
     if(app->settings->otg_auto_on && !power_is_otg_enabled(app->power)) {
         power_enable_otg(app->power, true);
     }
+    return true;
+}
 
+/**
+ * @brief Apply the result of the sensor poll
+ * @param sensor Pointer to sensor
+ * @param status Status returned by the updater
+ * @return Sensor poll status
+ */
+static SensorStatus unitemp_sensor_update_finish(Sensor* sensor, SensorStatus status) {
     //Если датчик дважды не ответил, то он переводится в неинициализированные (требуется для BME* и SDC30)
-    SensorStatus status = sensor->model->interface->updater(sensor);
     if(status == UT_SENSORSTATUS_TIMEOUT && sensor->status == UT_SENSORSTATUS_TIMEOUT) {
         unitemp_sensor_deinit(sensor);
         FURI_LOG_W(
@@ -269,6 +320,17 @@ SensorStatus unitemp_sensor_update(Sensor* sensor, void* context) {
     return sensor->status;
 }
 
+SensorStatus unitemp_sensor_update(Sensor* sensor, void* context) {
+    if(sensor == NULL || context == NULL) {
+        return UT_SENSORSTATUS_ERROR;
+    }
+
+    SensorStatus status;
+    if(!unitemp_sensor_update_prepare(sensor, context, &status)) return status;
+
+    return unitemp_sensor_update_finish(sensor, sensor->model->interface->updater(sensor));
+}
+
 bool unitemp_sensor_in_list(Sensor* sensor) {
     for(uint8_t i = 0; i < unitemp_sensors_get_count(); i++) {
         if(sensors_list[i] == sensor) return true;
@@ -276,6 +338,57 @@ bool unitemp_sensor_in_list(Sensor* sensor) {
     return false;
 }
 
+/**
+ * @brief Get the polling group of the sensor
+ * Sensors behind the same I2C multiplexer channel are in the same group
+ */
+static uint16_t unitemp_sensor_get_poll_group(Sensor* sensor) {
+    if(sensor->model->interface != &unitemp_i2c) return 0;
+    return unitemp_i2c_get_segment(sensor->instance);
+}
+
+/**
+ * @brief Sort sensors for polling so that the multiplexer channels are switched once per cycle
+ * @return Number of sensors to poll
+ */
+static uint8_t unitemp_sensors_sort_poll_order(void) {
+    uint8_t count = unitemp_sensors_get_count();
+    //Stable insertion sort, the number of sensors is small
+    for(uint8_t i = 0; i < count; i++) {
+        uint8_t j = i;
+        uint16_t group = unitemp_sensor_get_poll_group(sensors_list[i]);
+        while(j > 0 &&
+              unitemp_sensor_get_poll_group(sensors_list[sensors_poll_order[j - 1]]) > group) {
+            sensors_poll_order[j] = sensors_poll_order[j - 1];
+            j--;
+        }
+        sensors_poll_order[j] = i;
+    }
+    return count;
+}
+
+/**
+ * @brief Get the time until the next sensor must be polled
+ * @return Time in ms, no more than the display update period
+ */
+static uint32_t unitemp_sensors_get_poll_delay(void) {
+    uint32_t delay = DISPLAY_UPDATE_PERIOD_MS;
+    uint32_t now = furi_get_tick();
+    for(uint8_t i = 0; i < sensors_count; i++) {
+        Sensor* sensor = sensors_list[i];
+        if(sensor->status == UT_SENSORSTATUS_INACTIVE) continue;
+        uint32_t elapsed = now - sensor->last_polling_time;
+        uint32_t interval = unitemp_sensor_get_interval(sensor);
+        uint32_t left = elapsed < interval ? interval - elapsed : 0;
+        if(left < delay) delay = left;
+    }
+    //1-Wire buses are stepped on their own schedule
+    uint32_t onewire_delay = unitemp_onewire_buses_get_delay();
+    if(onewire_delay < delay) delay = onewire_delay;
+    //At least one tick so that the other threads get the processor time
+    return delay > 0 ? delay : 1;
+}
+
 /* Periodically requests measurements and reads temperature. This function runs in a separare thread. */
 int32_t unitemp_sensors_update_callback(void* context) {
     furi_check(context);
@@ -283,13 +396,66 @@ int32_t unitemp_sensors_update_callback(void* context) {
     UnitempApp* app = context;
 
     for(;;) {
-        for(uint8_t i = 0; i < unitemp_sensors_get_count(); i++) {
-            Sensor* sensor = unitemp_sensors_get(i);
+        //Conversions that have finished on any bus are read out before the sensors are polled
+        unitemp_onewire_buses_update();
+        uint8_t count = unitemp_sensors_sort_poll_order();
+        uint8_t pipeline_count = 0;
+        uint8_t singlewire_count = 0;
+        uint8_t spi_count = 0;
+        for(uint8_t i = 0; i < count; i++) {
+            Sensor* sensor = unitemp_sensors_get(sensors_poll_order[i]);
+            if(app->settings->singlewire_group && unitemp_singlewire_sensor_is_ready(sensor) &&
+               singlewire_count < SINGLEWIRE_SENSORS_MAX) {
+                //The frame is captured together with the other ready sensors after this loop
+                SensorStatus status;
+                if(unitemp_sensor_update_prepare(sensor, app, &status)) {
+                    sensors_singlewire[singlewire_count++] = sensor;
+                }
+                continue;
+            }
+            if(unitemp_spi_sensor_is_batched(sensor) && spi_count < SPI_SENSORS_MAX) {
+                //The frame is read together with the other SPI sensors after this loop
+                SensorStatus status;
+                if(unitemp_sensor_update_prepare(sensor, app, &status)) {
+                    sensors_spi[spi_count++] = sensor;
+                }
+                continue;
+            }
+            if(app->settings->i2c_pipelining && unitemp_i2c_sensor_is_pipelined(sensor)) {
+                //The sensor is polled together with the others after this loop
+                SensorStatus status;
+                if(unitemp_sensor_update_prepare(sensor, app, &status)) {
+                    sensors_pipeline[pipeline_count++] = sensor;
+                }
+                continue;
+            }
             unitemp_sensor_update(sensor, app);
         }
+        if(pipeline_count > 0) {
+            unitemp_i2c_sensors_update_pipelined(
+                sensors_pipeline, sensors_pipeline_status, pipeline_count);
+            for(uint8_t i = 0; i < pipeline_count; i++) {
+                unitemp_sensor_update_finish(sensors_pipeline[i], sensors_pipeline_status[i]);
+            }
+        }
+        if(spi_count > 0) {
+            unitemp_spi_sensors_update_batched(sensors_spi, sensors_spi_status, spi_count);
+            for(uint8_t i = 0; i < spi_count; i++) {
+                unitemp_sensor_update_finish(sensors_spi[i], sensors_spi_status[i]);
+            }
+        }
+        if(singlewire_count > 0) {
+            unitemp_singlewire_sensors_update(
+                sensors_singlewire, sensors_singlewire_status, singlewire_count);
+            for(uint8_t i = 0; i < singlewire_count; i++) {
+                unitemp_sensor_update_finish(sensors_singlewire[i], sensors_singlewire_status[i]);
+            }
+        }
+        //The transactions of the cycle are written to the SD card while the buses are idle
+        unitemp_trace_flush();
 
         const uint32_t flags = furi_thread_flags_wait(
-            UnitempThreadFlagExit, FuriFlagWaitAny, DISPLAY_UPDATE_PERIOD_MS);
+            UnitempThreadFlagExit, FuriFlagWaitAny, unitemp_sensors_get_poll_delay());
 
         /* If an exit signal was received, return from this thread. */
         if(flags != (unsigned)FuriFlagErrorTimeout) break;
@@ -474,18 +640,36 @@ bool unitemp_sensors_save(void* context) {
                 app->file_stream, "%d\n", unitemp_singlewire_sensor_gpio_get(sensor)->num);
         }
         if(sensor->model->interface == &unitemp_spi) {
-            uint8_t gpio_num = ((SPISensor*)sensor->instance)->cs_pin->num;
-            stream_write_format(app->file_stream, "%d\n", gpio_num);
+            SPISensor* spi_sensor = sensor->instance;
+            stream_write_format(
+                app->file_stream,
+                "%d %d %d\n",
+                spi_sensor->cs_pin->num,
+                spi_sensor->clock,
+                spi_sensor->capture != NULL);
+        }
+
+        if(sensor->model->interface == &unitemp_virtual) {
+            VirtualSensor* virtual_sensor = sensor->instance;
+            stream_write_format(
+                app->file_stream, "%d %d\n", virtual_sensor->wave, virtual_sensor->latency);
         }
 
         if(sensor->model->interface == &unitemp_i2c) {
+            I2CSensor* i2c_sensor = sensor->instance;
             stream_write_format(
-                app->file_stream, "%X\n", ((I2CSensor*)sensor->instance)->current_i2c_adress);
+                app->file_stream,
+                "%X %X %d %d %d\n",
+                i2c_sensor->current_i2c_adress,
+                i2c_sensor->mux_i2c_adress,
+                i2c_sensor->mux_channel,
+                unitemp_i2c_get_sda_pin(i2c_sensor)->num,
+                unitemp_i2c_get_scl_pin(i2c_sensor)->num);
         }
         if(sensor->model->interface == &unitemp_1w) {
             stream_write_format(
                 app->file_stream,
-                "%d %02X%02X%02X%02X%02X%02X%02X%02X\n",
+                "%d %02X%02X%02X%02X%02X%02X%02X%02X %d %d %d\n",
                 ((OneWireSensor*)sensor->instance)->bus->bus_pin->num,
                 ((OneWireSensor*)sensor->instance)->deviceID[0],
                 ((OneWireSensor*)sensor->instance)->deviceID[1],
@@ -494,7 +678,10 @@ bool unitemp_sensors_save(void* context) {
                 ((OneWireSensor*)sensor->instance)->deviceID[4],
                 ((OneWireSensor*)sensor->instance)->deviceID[5],
                 ((OneWireSensor*)sensor->instance)->deviceID[6],
-                ((OneWireSensor*)sensor->instance)->deviceID[7]);
+                ((OneWireSensor*)sensor->instance)->deviceID[7],
+                ((OneWireSensor*)sensor->instance)->resolution,
+                ((OneWireSensor*)sensor->instance)->alarm_high,
+                ((OneWireSensor*)sensor->instance)->alarm_low);
         }
     }
 
@@ -510,6 +697,7 @@ bool unitemp_sensors_init(void* context) {
     UnitempApp* app = context;
 
     bool result = true;
+    unitemp_trace_start(app->storage);
 
     //Searching through sensors from the list
     for(uint8_t i = 0; i < unitemp_sensors_get_count(); i++) {
@@ -529,6 +717,7 @@ bool unitemp_sensors_init(void* context) {
         } else {
             FURI_LOG_I(APP_NAME, "Sensor %s successfully initialized", sensors_list[i]->name);
         }
+        unitemp_trace_flush();
     }
     return result;
 }
@@ -555,6 +744,7 @@ bool unitemp_sensors_deinit(void* context) {
             sensors_list[i]->status = UT_SENSORSTATUS_UNINITIALIZED;
         }
     }
+    unitemp_trace_stop();
 
     return result;
 }
@@ -39,6 +39,7 @@ typedef enum {
     UT_SENSORSTATUS_EARLYPOOL, //Poll before the required delay
     UT_SENSORSTATUS_BADCRC, //Invalid checksum
     UT_SENSORSTATUS_ERROR, //Other errors
+    UT_SENSORSTATUS_FAULT, //The sensor reported a fault of its probe
     UT_SENSORSTATUS_POLLING, //A transformation occurs in the sensor
     UT_SENSORSTATUS_INACTIVE, //The sensor is being edited or deleted
     UT_SENSORSTATUS_UNINITIALIZED,
@@ -124,6 +125,10 @@ typedef struct Sensor {
     SensorStatus status;
     //Time of the last sensor poll
     uint32_t last_polling_time;
+    //Sensor polling interval (ms), the model interval unless the sensor settings change it
+    uint16_t polling_interval;
+    //Delay (ms) after which the driver continues an unfinished poll (0 - the polling interval)
+    uint16_t resume_delay;
     //Sensor instance
     void* instance;
 } Sensor;
@@ -19,6 +19,7 @@
 #include "AM2320.h"
 #include "interfaces/singlewire_sensor.h"
 #include "../interfaces/i2c_sensor.h"
+#include "../helpers/unitemp_crc.h"
 
 const SensorModel AM2320_SW = {
     .modelname = "AM2320",
@@ -44,23 +45,6 @@ const SensorModel AM2320_I2C = {
     .deinitializer = unitemp_AM2320_I2C_deinit,
     .updater = unitemp_AM2320_I2C_update};
 
-static uint16_t AM2320_calc_CRC(uint8_t* ptr, uint8_t len) {
-    uint16_t crc = 0xFFFF;
-    uint8_t i;
-    while(len--) {
-        crc ^= *ptr++;
-        for(i = 0; i < 8; i++) {
-            if(crc & 0x01) {
-                crc >>= 1;
-                crc ^= 0xA001;
-            } else {
-                crc >>= 1;
-            }
-        }
-    }
-    return crc;
-}
-
 bool unitemp_AM2320_I2C_alloc(Sensor* sensor, char* args) {
     UNUSED(args);
     I2CSensor* i2c_sensor = (I2CSensor*)sensor->instance;
@@ -104,7 +88,7 @@ SensorStatus unitemp_AM2320_I2C_update(Sensor* sensor) {
     //Answer
     if(!unitemp_i2c_read_array(i2c_sensor, 8, data)) return UT_SENSORSTATUS_TIMEOUT;
 
-    if(AM2320_calc_CRC(data, 6) != ((data[7] << 8) | data[6])) {
+    if(unitemp_crc16_modbus(data, 6) != ((data[7] << 8) | data[6])) {
         return UT_SENSORSTATUS_BADCRC;
     }
 
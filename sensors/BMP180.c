@@ -35,8 +35,13 @@ typedef struct {
 typedef struct {
     //Calibration values
     BMP180_cal bmp180_cal;
+    //Temperature compensation coefficient of the last measurement
+    int32_t B5;
 } BMP180_instance;
 
+static uint16_t BMP180_start(Sensor* sensor, uint8_t step);
+static SensorStatus BMP180_read(Sensor* sensor, uint8_t step);
+
 const SensorModel BMP180 = {
     .modelname = "BMP180",
     .interface = &unitemp_i2c,
@@ -58,6 +63,10 @@ bool unitemp_BMP180_I2C_alloc(Sensor* sensor, char* args) {
 
     BMP180_instance* bmx280_instance = malloc(sizeof(BMP180_instance));
     i2c_sensor->sensor_instance = bmx280_instance;
+
+    //Measurement split for the pipelined poll
+    i2c_sensor->pipeline_start = BMP180_start;
+    i2c_sensor->pipeline_read = BMP180_read;
     return true;
 }
 
@@ -125,30 +134,51 @@ bool unitemp_BMP180_I2C_deinit(Sensor* sensor) {
 }
 
 SensorStatus unitemp_BMP180_I2C_update(Sensor* sensor) {
+    SensorStatus status;
+    unitemp_i2c_sensors_update_pipelined(&sensor, &status, 1);
+    return status;
+}
+
+static uint16_t BMP180_start(Sensor* sensor, uint8_t step) {
     I2CSensor* i2c_sensor = (I2CSensor*)sensor->instance;
-    BMP180_instance* bmp180_instance = i2c_sensor->sensor_instance;
 
-    //Temperature reading
-    if(!unitemp_i2c_write_reg(i2c_sensor, 0xF4, 0x2E)) return UT_SENSORSTATUS_TIMEOUT;
-    furi_delay_ms(5);
+    if(step == 0) {
+        //Temperature measurement
+        if(!unitemp_i2c_write_reg(i2c_sensor, 0xF4, 0x2E)) return 0;
+        return 5;
+    }
+    //Pressure measurement with the maximum oversampling
+    if(!unitemp_i2c_write_reg(i2c_sensor, 0xF4, 0x34 + (0b11 << 6))) return 0;
+    return 26;
+}
+
+static SensorStatus BMP180_read(Sensor* sensor, uint8_t step) {
+    I2CSensor* i2c_sensor = (I2CSensor*)sensor->instance;
+    BMP180_instance* bmp180_instance = i2c_sensor->sensor_instance;
     uint8_t buff[3] = {0};
-    if(!unitemp_i2c_read_reg_array(i2c_sensor, 0xF6, 2, buff)) return UT_SENSORSTATUS_TIMEOUT;
-    int32_t UT = ((uint16_t)buff[0] << 8) + buff[1];
-    int32_t X1 = (UT - bmp180_instance->bmp180_cal.AC6) * bmp180_instance->bmp180_cal.AC5 >> 15;
-    int32_t X2 = (bmp180_instance->bmp180_cal.MC << 11) / (X1 + bmp180_instance->bmp180_cal.MD);
-    int32_t B5 = X1 + X2;
-    sensor->temperature = ((B5 + 8) / 16) * 0.1f;
+
+    if(step == 0) {
+        //Temperature reading
+        if(!unitemp_i2c_read_reg_array(i2c_sensor, 0xF6, 2, buff))
+            return UT_SENSORSTATUS_TIMEOUT;
+        int32_t UT = ((uint16_t)buff[0] << 8) + buff[1];
+        int32_t X1 = (UT - bmp180_instance->bmp180_cal.AC6) * bmp180_instance->bmp180_cal.AC5 >>
+                     15;
+        int32_t X2 = (bmp180_instance->bmp180_cal.MC << 11) /
+                     (X1 + bmp180_instance->bmp180_cal.MD);
+        bmp180_instance->B5 = X1 + X2;
+        sensor->temperature = ((bmp180_instance->B5 + 8) / 16) * 0.1f;
+        //Pressure is measured at the next step
+        return UT_SENSORSTATUS_POLLING;
+    }
 
     //Pressure reading
-    if(!unitemp_i2c_write_reg(i2c_sensor, 0xF4, 0x34 + (0b11 << 6)))
-        return UT_SENSORSTATUS_TIMEOUT;
-    furi_delay_ms(26);
     if(!unitemp_i2c_read_reg_array(i2c_sensor, 0xF6, 3, buff)) return UT_SENSORSTATUS_TIMEOUT;
     uint32_t UP = ((buff[0] << 16) + (buff[1] << 8) + buff[2]) >> (8 - 0b11);
 
-    int32_t B6, X3, B3, P;
+    int32_t X1, X2, B6, X3, B3, P;
     uint32_t B4, B7;
-    B6 = B5 - 4000;
+    B6 = bmp180_instance->B5 - 4000;
     X1 = (bmp180_instance->bmp180_cal.B2 * ((B6 * B6) >> 12)) >> 11;
     X2 = (bmp180_instance->bmp180_cal.AC2 * B6) >> 11;
     X3 = X1 + X2;
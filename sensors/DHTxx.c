@@ -19,6 +19,18 @@
 #include "DHTxx.h"
 #include "interfaces/singlewire_sensor.h"
 #include "interfaces/i2c_sensor.h"
+#include "helpers/unitemp_crc.h"
+
+//Conversion time of the DHT20/AHTxx measurement, ms
+#define DHT20_CONVERSION_TIME_MS 80
+//Extra wait if the conversion is not finished in time, ms
+#define DHT20_BUSY_WAIT_MS 20
+
+//State of the DHT20/AHTxx measurement
+typedef struct {
+    //The measurement is started and its result has not been read yet
+    bool measuring;
+} DHT20_instance;
 
 const SensorModel DHT11 = {
     .modelname = "DHT11",
@@ -92,22 +104,6 @@ static uint8_t DHT20_get_status(I2CSensor* i2c_sensor) {
     return status[0];
 }
 
-static uint8_t DHT20_calc_CRC8(uint8_t* message, uint8_t Num) {
-    uint8_t i;
-    uint8_t byte;
-    uint8_t crc = 0xFF;
-    for(byte = 0; byte < Num; byte++) {
-        crc ^= (message[byte]);
-        for(i = 8; i > 0; --i) {
-            if(crc & 0x80)
-                crc = (crc << 1) ^ 0x31;
-            else
-                crc = (crc << 1);
-        }
-    }
-    return crc;
-}
-
 static void DHT20_reset_reg(I2CSensor* i2c_sensor, uint8_t addr) {
     uint8_t data[3] = {addr, 0x00, 0x00};
 
@@ -130,12 +126,20 @@ bool unitemp_DHT20_I2C_alloc(Sensor* sensor, char* args) {
     //Addresses on the I2C bus (7 bits)
     i2c_sensor->min_i2c_adress = 0x38 << 1;
     i2c_sensor->max_i2c_adress = (sensor->model == &DHT20) ? (0x38 << 1) : (0x39 << 1);
+
+    DHT20_instance* instance = malloc(sizeof(DHT20_instance));
+    if(instance == NULL) return false;
+    instance->measuring = false;
+    i2c_sensor->sensor_instance = instance;
     return true;
 }
 
 bool unitemp_DHT20_I2C_free(Sensor* sensor) {
-    //Nothing to release since nothing was allocated
-    UNUSED(sensor);
+    I2CSensor* i2c_sensor = (I2CSensor*)sensor->instance;
+    DHT20_instance* instance = i2c_sensor->sensor_instance;
+    if(instance == NULL) return true;
+    free(instance);
+    i2c_sensor->sensor_instance = NULL;
     return true;
 }
 
@@ -154,32 +158,49 @@ bool unitemp_DHT20_init(Sensor* sensor) {
 }
 
 bool unitemp_DHT20_I2C_deinit(Sensor* sensor) {
-    //Nothing to deinitialize
-    UNUSED(sensor);
+    I2CSensor* i2c_sensor = (I2CSensor*)sensor->instance;
+    DHT20_instance* instance = i2c_sensor->sensor_instance;
+    //The started measurement is dropped, the next poll starts a new one
+    instance->measuring = false;
+    sensor->resume_delay = 0;
     return true;
 }
 
 SensorStatus unitemp_DHT20_I2C_update(Sensor* sensor) {
     I2CSensor* i2c_sensor = (I2CSensor*)sensor->instance;
-
-    if(DHT20_get_status(i2c_sensor) != 0x18) {
-        DHT20_reset_reg(i2c_sensor, 0x1B);
-        DHT20_reset_reg(i2c_sensor, 0x1C);
-        DHT20_reset_reg(i2c_sensor, 0x1E);
+    DHT20_instance* instance = i2c_sensor->sensor_instance;
+
+    //The measurement is started on the poll and read out when the poller resumes the sensor
+    if(!instance->measuring) {
+        if(DHT20_get_status(i2c_sensor) != 0x18) {
+            DHT20_reset_reg(i2c_sensor, 0x1B);
+            DHT20_reset_reg(i2c_sensor, 0x1C);
+            DHT20_reset_reg(i2c_sensor, 0x1E);
+            furi_delay_ms(10);
+        }
+        uint8_t command[3] = {0xAC, 0x33, 0x00};
+        if(!unitemp_i2c_write_array(i2c_sensor, 3, command)) return UT_SENSORSTATUS_TIMEOUT;
+        instance->measuring = true;
+        sensor->resume_delay = DHT20_CONVERSION_TIME_MS;
+        return UT_SENSORSTATUS_POLLING;
     }
-    furi_delay_ms(10);
 
-    uint8_t data[7] = {0xAC, 0x33, 0x00};
-    if(!unitemp_i2c_write_array(i2c_sensor, 3, data)) return UT_SENSORSTATUS_TIMEOUT;
-    furi_delay_ms(80);
-    uint32_t t = furi_get_tick();
-    while(DHT20_get_status(i2c_sensor) == 0x80) {
-        if(furi_get_tick() - t > 10) return UT_SENSORSTATUS_TIMEOUT;
+    uint8_t data[7];
+    if(!unitemp_i2c_read_array(i2c_sensor, 7, data)) {
+        instance->measuring = false;
+        sensor->resume_delay = 0;
+        return UT_SENSORSTATUS_TIMEOUT;
     }
+    //The conversion is not finished yet, the wait is extended once
+    if((data[0] & 0x80) && sensor->resume_delay == DHT20_CONVERSION_TIME_MS) {
+        sensor->resume_delay += DHT20_BUSY_WAIT_MS;
+        return UT_SENSORSTATUS_POLLING;
+    }
+    instance->measuring = false;
+    sensor->resume_delay = 0;
+    if(data[0] & 0x80) return UT_SENSORSTATUS_TIMEOUT;
 
-    if(!unitemp_i2c_read_array(i2c_sensor, 7, data)) return UT_SENSORSTATUS_TIMEOUT;
-
-    if(DHT20_calc_CRC8(data, 6) != data[6]) {
+    if(unitemp_crc8_sensirion(data, 6) != data[6]) {
         return UT_SENSORSTATUS_BADCRC;
     }
     uint32_t RetuData = 0;
@@ -27,6 +27,7 @@ const SensorModel Dallas = {
     .altname = "DS18B20(22)/DS1820",
     .interface = &unitemp_1w,
     .data_type = UT_DATA_TYPE_TEMP,
+    //Conversion time at 12 bits, the sensor interval follows its resolution
     .polling_interval = 750,
     .allocator = unitemp_ds18x2x_sensor_alloc,
     .mem_releaser = unitemp_ds18x2x_sensor_free,
@@ -34,10 +35,54 @@ const SensorModel Dallas = {
     .deinitializer = unitemp_ds18x2x_sensor_deinit,
     .updater = unitemp_ds18x2x_sensor_update};
 
-#define DS18B20_CMD_SKIP_ROM        0xCCU
 #define DS18B20_CMD_CONVERT         0x44U
 #define DS18B20_CMD_READ_SCRATCHPAD 0xBEU
 
+//Conversion time at 12-bit resolution, ms
+#define DS18X2X_CONVERSION_TIME_MS 750
+//Resolution limits, bits
+#define DS18X2X_RESOLUTION_MIN 9
+#define DS18X2X_RESOLUTION_MAX 12
+//Number of conversion end checks per conversion time of externally powered devices
+#define DS18X2X_COMPLETION_CHECKS 4
+//Default alarm limits, °C
+#define DS18X2X_ALARM_HIGH_DEFAULT 0x4B
+#define DS18X2X_ALARM_LOW_DEFAULT  0x46
+
+/**
+ * @brief Get the conversion time of the sensor
+ * @param instance Pointer to the sensor instance
+ * @return Time in ms
+ */
+static uint16_t unitemp_ds18x2x_get_conversion_time(OneWireSensor* instance) {
+    //DS18S20 has a fixed resolution
+    if(instance->family_code == FC_DS18S20) return DS18X2X_CONVERSION_TIME_MS;
+    //The time is halved with each bit less, rounded up
+    uint8_t shift = DS18X2X_RESOLUTION_MAX - instance->resolution;
+    return (DS18X2X_CONVERSION_TIME_MS + (1 << shift) - 1) >> shift;
+}
+
+/**
+ * @brief Set the sensor polling interval according to the conversion time and the bus power mode
+ * @param sensor Pointer to sensor
+ */
+static void unitemp_ds18x2x_update_polling_interval(Sensor* sensor) {
+    OneWireSensor* instance = sensor->instance;
+    sensor->polling_interval = unitemp_ds18x2x_get_conversion_time(instance);
+    //Externally powered devices report the end of the conversion, so it is checked more often
+    if(instance->bus != NULL && instance->bus->power_mode == PWR_ACTIVE) {
+        sensor->polling_interval /= DS18X2X_COMPLETION_CHECKS;
+    }
+}
+
+void unitemp_ds18x2x_set_resolution(Sensor* sensor, uint8_t resolution) {
+    OneWireSensor* instance = sensor->instance;
+    if(resolution < DS18X2X_RESOLUTION_MIN) resolution = DS18X2X_RESOLUTION_MIN;
+    if(resolution > DS18X2X_RESOLUTION_MAX) resolution = DS18X2X_RESOLUTION_MAX;
+    instance->resolution = resolution;
+    unitemp_ds18x2x_update_polling_interval(sensor);
+}
+
 bool unitemp_ds18x2x_sensor_alloc(Sensor* sensor, char* args) {
     OneWireSensor* instance = malloc(sizeof(OneWireSensor));
     if(instance == NULL) {
@@ -47,11 +92,16 @@ bool unitemp_ds18x2x_sensor_alloc(Sensor* sensor, char* args) {
     sensor->instance = instance;
     //Address clearing
     memset(instance->deviceID, 0, 8);
+    instance->status = UT_SENSORSTATUS_UNINITIALIZED;
+    instance->fresh = false;
 
     int gpio_pin, addr_0, addr_1, addr_2, addr_3, addr_4, addr_5, addr_6, addr_7;
+    //Sensors saved without resolution use 12 bits and the former fixed alarm limits
+    int resolution = DS18X2X_RESOLUTION_MAX;
+    int alarm_high = DS18X2X_ALARM_HIGH_DEFAULT, alarm_low = DS18X2X_ALARM_LOW_DEFAULT;
     sscanf(
         args,
-        "%d %2X%2X%2X%2X%2X%2X%2X%2X",
+        "%d %2X%2X%2X%2X%2X%2X%2X%2X %d %d %d",
         &gpio_pin,
         &addr_0,
         &addr_1,
@@ -60,7 +110,10 @@ bool unitemp_ds18x2x_sensor_alloc(Sensor* sensor, char* args) {
         &addr_4,
         &addr_5,
         &addr_6,
-        &addr_7);
+        &addr_7,
+        &resolution,
+        &alarm_high,
+        &alarm_low);
     instance->deviceID[0] = addr_0;
     instance->deviceID[1] = addr_1;
     instance->deviceID[2] = addr_2;
@@ -71,8 +124,19 @@ bool unitemp_ds18x2x_sensor_alloc(Sensor* sensor, char* args) {
     instance->deviceID[7] = addr_7;
 
     instance->family_code = instance->deviceID[0];
+    instance->overdrive = unitemp_onewire_family_has_overdrive(instance->family_code);
+    unitemp_ds18x2x_set_resolution(sensor, resolution);
+    if(alarm_high < DS18X2X_ALARM_MIN || alarm_high > DS18X2X_ALARM_MAX)
+        alarm_high = DS18X2X_ALARM_HIGH_DEFAULT;
+    if(alarm_low < DS18X2X_ALARM_MIN || alarm_low > DS18X2X_ALARM_MAX)
+        alarm_low = DS18X2X_ALARM_LOW_DEFAULT;
+    //The lower limit above the upper one puts the device in alarm at any temperature
+    if(alarm_low > alarm_high) alarm_low = alarm_high;
+    instance->alarm_high = alarm_high;
+    instance->alarm_low = alarm_low;
 
     instance->bus = unitemp_onewire_bus_alloc(unitemp_gpio_get_from_int(gpio_pin));
+    unitemp_onewire_bus_add_device(instance->bus, instance);
 
     if(instance != NULL) {
         return true;
@@ -83,12 +147,28 @@ bool unitemp_ds18x2x_sensor_alloc(Sensor* sensor, char* args) {
 }
 
 bool unitemp_ds18x2x_sensor_free(Sensor* sensor) {
-    unitemp_onewire_bus_free(((OneWireSensor*)sensor->instance)->bus);
+    OneWireSensor* instance = sensor->instance;
+    unitemp_onewire_bus_remove_device(instance->bus, instance);
+    unitemp_onewire_bus_free(instance->bus);
     free(sensor->instance);
 
     return true;
 }
 
+/**
+ * @brief Read the scratchpad of the sensor
+ * @param instance Pointer to the sensor instance
+ * @return Reading status
+ */
+static SensorStatus unitemp_ds18x2x_read_scratchpad(OneWireSensor* instance) {
+    if(!unitemp_onewire_bus_start(instance->bus)) return UT_SENSORSTATUS_TIMEOUT;
+    unitemp_onewire_sensor_select(instance);
+    unitemp_onewire_bus_write(instance->bus, DS18B20_CMD_READ_SCRATCHPAD); // Read Scratch-pad
+    unitemp_onewire_bus_read_bytes(instance->bus, instance->scratchpad, 9);
+    if(!unitemp_onewire_CRC_check(instance->scratchpad, 9)) return UT_SENSORSTATUS_BADCRC;
+    return UT_SENSORSTATUS_OK;
+}
+
 bool unitemp_ds18x2x_sensor_init(Sensor* sensor) {
     OneWireSensor* instance = sensor->instance;
     if(instance == NULL || instance->bus == NULL) {
@@ -99,28 +179,41 @@ bool unitemp_ds18x2x_sensor_init(Sensor* sensor) {
     unitemp_onewire_bus_init(instance->bus);
     furi_delay_ms(1);
 
+    //The conversion of the other sensors is aborted by the first reset and started again
+    //by the bus cycle. Results of the previous cycles are outdated
+    instance->fresh = false;
+
     bool result = false;
-    if(instance->family_code == FC_DS18B20 || instance->family_code == FC_DS1822) {
-        FURI_CRITICAL_ENTER();
+    if(instance->family_code == FC_DS18B20 || instance->family_code == FC_DS1822 ||
+       instance->family_code == FC_DS28EA00) {
+        //Alarm values and configuration
+        uint8_t config[3];
+        config[0] = instance->alarm_high; //Upper temperature limit value
+        config[1] = instance->alarm_low; //Temperature lower limit value
+        config[2] = ((instance->resolution - DS18X2X_RESOLUTION_MIN) << 5) | 0b00011111;
+
+        //Interrupts are only masked inside the time slots by the host, a transaction may be
+        //paused between the slots without harm
+        bool copy = false;
         do {
-            //Setting the bit depth to 10 bits
-            if(!unitemp_onewire_bus_start(instance->bus)) {
+            //The configuration stored in the device is checked first
+            SensorStatus status = unitemp_ds18x2x_read_scratchpad(instance);
+            if(status == UT_SENSORSTATUS_TIMEOUT) {
                 UNITEMP_DEBUG(
                     "Failed to start bus %s for sensor %s",
                     instance->bus->bus_pin->name,
                     sensor->name);
                 break;
             }
-            unitemp_onewire_bus_select_device(instance->bus, instance->deviceID);
+            if(status == UT_SENSORSTATUS_OK && memcmp(instance->scratchpad + 2, config, 3) == 0) {
+                result = true;
+                break;
+            }
 
+            if(!unitemp_onewire_bus_start(instance->bus)) break;
+            unitemp_onewire_sensor_select(instance);
             unitemp_onewire_bus_write(instance->bus, 0x4E); //Memory recording
-            uint8_t buff[3];
-            //Alarm values
-            buff[0] = 0x4B; //Temperature lower limit value
-            buff[1] = 0x46; //Upper temperature limit value
-            //Configuration
-            buff[2] = 0b01111111; //12 bit bit conversion
-            unitemp_onewire_bus_write_bytes(instance->bus, buff, 3);
+            unitemp_onewire_bus_write_bytes(instance->bus, config, 3);
 
             //Stores values ​​in EEPROM for automatic recovery after power failures
             if(!unitemp_onewire_bus_start(instance->bus)) {
@@ -130,13 +223,38 @@ bool unitemp_ds18x2x_sensor_init(Sensor* sensor) {
                     sensor->name);
                 break;
             }
-            unitemp_onewire_bus_select_device(instance->bus, instance->deviceID);
-            unitemp_onewire_bus_write(instance->bus, 0x48); //Write to EEPROM
+            unitemp_onewire_sensor_select(instance);
+            if(instance->bus->power_mode == PWR_PASSIVE && !unitemp_trace_is_replaying()) {
+                //Parasite-powered devices need the strong pull-up right after the command,
+                //so only this byte is not interrupted. The trace takes a mutex and may
+                //write the SD card, so the byte is traced after the window
+                const uint8_t cmd = 0x48; //Write to EEPROM
+                FURI_CRITICAL_ENTER();
+                onewire_host_write(instance->bus->host, cmd);
+                unitemp_onewire_bus_strong_mode(instance->bus, true);
+                FURI_CRITICAL_EXIT();
+                unitemp_trace_record(
+                    UnitempTraceBusOneWire,
+                    UnitempTraceDirWrite,
+                    instance->bus->bus_pin->num,
+                    0,
+                    &cmd,
+                    1,
+                    true);
+            } else {
+                unitemp_onewire_bus_write(instance->bus, 0x48); //Write to EEPROM
+            }
+            copy = true;
             result = true;
         } while(0);
-        FURI_CRITICAL_EXIT();
+
+        if(copy) {
+            //EEPROM write time
+            furi_delay_ms(10);
+            unitemp_onewire_bus_strong_mode(instance->bus, false);
+            UNITEMP_DEBUG("Sensor %s configuration saved to EEPROM", sensor->name);
+        }
     } else {
-        FURI_CRITICAL_ENTER();
         do {
             if(!unitemp_onewire_bus_start(instance->bus)) {
                 UNITEMP_DEBUG(
@@ -146,7 +264,7 @@ bool unitemp_ds18x2x_sensor_init(Sensor* sensor) {
                 break;
             }
             uint8_t buff[9];
-            unitemp_onewire_bus_select_device(instance->bus, instance->deviceID);
+            unitemp_onewire_sensor_select(instance);
             unitemp_onewire_bus_write(
                 instance->bus, DS18B20_CMD_READ_SCRATCHPAD); // Read Scratch-pad
             unitemp_onewire_bus_read_bytes(instance->bus, buff, 9);
@@ -156,9 +274,13 @@ bool unitemp_ds18x2x_sensor_init(Sensor* sensor) {
             }
             result = true;
         } while(0);
-        FURI_CRITICAL_EXIT();
     }
 
+    if(result) {
+        //The power mode is checked again as devices may have been added to the bus
+        unitemp_onewire_bus_read_power_mode(instance->bus);
+        unitemp_ds18x2x_update_polling_interval(sensor);
+    }
     if(!result) unitemp_onewire_bus_deinit(instance->bus);
 
     return result;
@@ -172,51 +294,145 @@ bool unitemp_ds18x2x_sensor_deinit(Sensor* sensor) {
     return true;
 }
 
-SensorStatus unitemp_ds18x2x_sensor_update(Sensor* sensor) {
-    //Removing the special status from the sensor in passive power mode
-    if(sensor->status == UT_SENSORSTATUS_EARLYPOOL) {
-        return UT_SENSORSTATUS_POLLING;
+/**
+ * @brief Read the sensors of the bus in the alarm search mode
+ * 
+ * Only the devices reporting an alarm are read. One of the sensors in range
+ * is read per cycle, so they are refreshed in turn.
+ * 
+ * @param bus Pointer to one wire bus
+ */
+static void unitemp_ds18x2x_bus_read_alarms(UnitempOneWireBus* bus) {
+    unitemp_onewire_bus_enum_init(bus);
+    //The number of search passes is limited in case of noise on the line
+    for(uint8_t pass = 0; pass < UNITEMP_ONEWIRE_DEVICES_MAX * 2; pass++) {
+        uint8_t* id = unitemp_onewire_bus_alarm_next(bus);
+        if(id == NULL) break;
+        if(!unitemp_onewire_CRC_check(id, 8)) continue;
+        for(uint8_t i = 0; i < bus->sensors_count; i++) {
+            OneWireSensor* instance = bus->sensors[i];
+            if(!unitemp_onewire_id_compare(id, instance->deviceID)) continue;
+            instance->status = unitemp_ds18x2x_read_scratchpad(instance);
+            instance->fresh = true;
+            break;
+        }
     }
 
-    OneWireSensor* instance = sensor->instance;
-    uint8_t buff[9] = {0};
-
-    if(sensor->status != UT_SENSORSTATUS_POLLING) {
-        if(!unitemp_onewire_bus_start(instance->bus)) return UT_SENSORSTATUS_TIMEOUT;
-        //Starting conversion on all sensors in passive power mode
-        unitemp_onewire_bus_write(instance->bus, DS18B20_CMD_SKIP_ROM); // skip addr
-        //Setting a special status on all sensors of this bus so as not to start the conversion again
-        for(uint8_t i = 0; i < unitemp_sensors_get_count(); i++) {
-            if(unitemp_sensors_get(i)->model->interface == &unitemp_1w &&
-               ((OneWireSensor*)unitemp_sensors_get(i)->instance)->bus == instance->bus) {
-                unitemp_sensors_get(i)->status = UT_SENSORSTATUS_EARLYPOOL;
-            }
+    //Background refresh of the sensors in range
+    for(uint8_t i = 0; i < bus->sensors_count; i++) {
+        if(bus->refresh_cursor >= bus->sensors_count) bus->refresh_cursor = 0;
+        OneWireSensor* instance = bus->sensors[bus->refresh_cursor++];
+        if(instance->family_code == 0 || instance->fresh) continue;
+        instance->status = unitemp_ds18x2x_read_scratchpad(instance);
+        instance->fresh = true;
+        break;
+    }
+}
+
+/**
+ * @brief Measurement cycle of the bus
+ * 
+ * One conversion is started on all devices of the bus at once. When it is over,
+ * the scratchpads are read one per step and the next conversion is started.
+ * 
+ * @param bus Pointer to one wire bus
+ */
+static void unitemp_ds18x2x_bus_cycle(UnitempOneWireBus* bus) {
+    if(bus->cycle_state == UnitempOneWireCycleConverting) {
+        if(furi_get_tick() - bus->convert_tick < furi_ms_to_ticks(bus->convert_time)) {
+            //Parasite-powered devices are waited for the full conversion time.
+            //Externally powered ones send 1 in a read slot when the conversion is over
+            if(bus->power_mode == PWR_PASSIVE) return;
+            if(!unitemp_onewire_bus_read_bit(bus)) return;
         }
+        if(bus->power_mode == PWR_PASSIVE) unitemp_onewire_bus_strong_mode(bus, false);
 
-        unitemp_onewire_bus_write(instance->bus, DS18B20_CMD_CONVERT); // convert t
+        if(unitemp_onewire_get_alarm_search()) {
+            //The conversion is over, the resets of the search do not abort it
+            bus->cycle_state = UnitempOneWireCycleIdle;
+            unitemp_ds18x2x_bus_read_alarms(bus);
+        } else {
+            bus->read_cursor = 0;
+            bus->cycle_state = UnitempOneWireCycleReading;
+        }
+    }
 
-        unitemp_onewire_bus_strong_mode(instance->bus, true);
-        return UT_SENSORSTATUS_POLLING;
-    } else {
-        unitemp_onewire_bus_strong_mode(instance->bus, false);
+    if(bus->cycle_state == UnitempOneWireCycleReading) {
+        //One scratchpad per step, the other buses are stepped in between
+        while(bus->read_cursor < bus->sensors_count) {
+            OneWireSensor* instance = bus->sensors[bus->read_cursor++];
+            if(instance->family_code == 0) continue;
+            instance->status = unitemp_ds18x2x_read_scratchpad(instance);
+            instance->fresh = true;
+            break;
+        }
+        if(bus->read_cursor < bus->sensors_count) return;
+        bus->cycle_state = UnitempOneWireCycleIdle;
+    }
 
-        if(!unitemp_onewire_bus_start(instance->bus)) return UT_SENSORSTATUS_TIMEOUT;
-        unitemp_onewire_bus_select_device(instance->bus, instance->deviceID);
-        unitemp_onewire_bus_write(instance->bus, DS18B20_CMD_READ_SCRATCHPAD); // Read Scratch-pad
-        unitemp_onewire_bus_read_bytes(instance->bus, buff, 9);
-        if(!unitemp_onewire_CRC_check(buff, 9)) {
-            UNITEMP_DEBUG("Failed CRC check: %s", sensor->name);
-            return UT_SENSORSTATUS_BADCRC;
+    if(!unitemp_onewire_bus_start(bus)) {
+        for(uint8_t i = 0; i < bus->sensors_count; i++) {
+            bus->sensors[i]->status = UT_SENSORSTATUS_TIMEOUT;
+            bus->sensors[i]->fresh = true;
         }
-        int16_t raw = buff[0] | ((int16_t)buff[1] << 8);
-        if(instance->family_code == FC_DS18S20) {
-            //Pseudo-12-bit.
-            //sensor->temperature = ((float)raw / 2.0f) - 0.25f + (16.0f - buff[6]) / 16.0f;
-            //Honest 9 bits
-            sensor->temperature = ((float)raw / 2.0f);
-        } else {
-            sensor->temperature = (float)raw / 16.0f;
+        return;
+    }
+    //Starting conversion on all sensors of the bus
+    unitemp_onewire_bus_skip_rom(bus); // skip addr
+    unitemp_onewire_bus_write(bus, DS18B20_CMD_CONVERT); // convert t
+    //The strong pull-up powers the conversion of parasite-powered devices
+    if(bus->power_mode == PWR_PASSIVE) unitemp_onewire_bus_strong_mode(bus, true);
+
+    //The wait is sized to the slowest sensor on the bus
+    bus->convert_tick = furi_get_tick();
+    bus->convert_time = 0;
+    for(uint8_t i = 0; i < bus->sensors_count; i++) {
+        uint16_t convert_time = unitemp_ds18x2x_get_conversion_time(bus->sensors[i]);
+        if(convert_time > bus->convert_time) bus->convert_time = convert_time;
+    }
+    bus->cycle_state = UnitempOneWireCycleConverting;
+}
+
+void unitemp_ds18x2x_bus_update(UnitempOneWireBus* bus) {
+    unitemp_ds18x2x_bus_cycle(bus);
+}
+
+uint32_t unitemp_ds18x2x_bus_get_delay(UnitempOneWireBus* bus) {
+    if(bus->cycle_state != UnitempOneWireCycleConverting) return 0;
+    uint32_t elapsed = furi_get_tick() - bus->convert_tick;
+    uint32_t convert_ticks = furi_ms_to_ticks(bus->convert_time);
+    if(elapsed >= convert_ticks) return 0;
+    uint32_t left = convert_ticks - elapsed;
+    //The end of the conversion of externally powered devices is checked in between
+    if(bus->power_mode == PWR_ACTIVE && convert_ticks / DS18X2X_COMPLETION_CHECKS < left) {
+        left = convert_ticks / DS18X2X_COMPLETION_CHECKS;
+    }
+    return left;
+}
+
+SensorStatus unitemp_ds18x2x_sensor_update(Sensor* sensor) {
+    OneWireSensor* instance = sensor->instance;
+    unitemp_ds18x2x_bus_cycle(instance->bus);
+
+    //Waiting for the end of the bus cycle
+    if(!instance->fresh) return UT_SENSORSTATUS_POLLING;
+    instance->fresh = false;
+    if(instance->status != UT_SENSORSTATUS_OK) {
+        if(instance->status == UT_SENSORSTATUS_BADCRC) {
+            UNITEMP_DEBUG("Failed CRC check: %s", sensor->name);
         }
+        return instance->status;
+    }
+
+    uint8_t* buff = instance->scratchpad;
+    int16_t raw = buff[0] | ((int16_t)buff[1] << 8);
+    if(instance->family_code == FC_DS18S20) {
+        //Pseudo-12-bit.
+        //sensor->temperature = ((float)raw / 2.0f) - 0.25f + (16.0f - buff[6]) / 16.0f;
+        //Honest 9 bits
+        sensor->temperature = ((float)raw / 2.0f);
+    } else {
+        sensor->temperature = (float)raw / 16.0f;
     }
 
     return UT_SENSORSTATUS_OK;
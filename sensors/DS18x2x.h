@@ -17,6 +17,7 @@
 */
 
 #include "../sensors.h"
+#include "../interfaces/onewire_sensor.h"
 
 #ifndef DS18X2X_H_
 #define DS18X2X_H_
@@ -57,4 +58,28 @@ bool unitemp_ds18x2x_sensor_deinit(Sensor* sensor);
  */
 SensorStatus unitemp_ds18x2x_sensor_update(Sensor* sensor);
 
+/**
+ * @brief Set the measurement resolution. Applied on the next sensor initialization
+ * @param sensor Pointer to sensor
+ * @param resolution Resolution in bits (9-12)
+ */
+void unitemp_ds18x2x_set_resolution(Sensor* sensor, uint8_t resolution);
+
+/**
+ * @brief Take one step of the bus measurement cycle
+ * @param bus Pointer to one wire bus
+ */
+void unitemp_ds18x2x_bus_update(UnitempOneWireBus* bus);
+
+/**
+ * @brief Get the time until the next step of the bus measurement cycle
+ * @param bus Pointer to one wire bus
+ * @return Time in ms
+ */
+uint32_t unitemp_ds18x2x_bus_get_delay(UnitempOneWireBus* bus);
+
+//Alarm limits range, °C
+#define DS18X2X_ALARM_MIN -55
+#define DS18X2X_ALARM_MAX 125
+
 #endif //DS18X2X_H_
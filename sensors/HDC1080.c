@@ -18,6 +18,9 @@
 #include "HDC1080.h"
 #include "../interfaces/i2c_sensor.h"
 
+static uint16_t HDC1080_start(Sensor* sensor, uint8_t step);
+static SensorStatus HDC1080_read(Sensor* sensor, uint8_t step);
+
 const SensorModel HDC1080 = {
     .modelname = "HDC1080",
     .interface = &unitemp_i2c,
@@ -36,6 +39,10 @@ bool unitemp_HDC1080_alloc(Sensor* sensor, char* args) {
     //Addresses on the I2C bus (7 bits)
     i2c_sensor->min_i2c_adress = 0x40 << 1;
     i2c_sensor->max_i2c_adress = 0x40 << 1;
+
+    //Measurement split for the pipelined poll
+    i2c_sensor->pipeline_start = HDC1080_start;
+    i2c_sensor->pipeline_read = HDC1080_read;
     return true;
 }
 
@@ -74,21 +81,33 @@ bool unitemp_HDC1080_deinit(Sensor* sensor) {
 }
 
 SensorStatus unitemp_HDC1080_update(Sensor* sensor) {
+    SensorStatus status;
+    unitemp_i2c_sensors_update_pipelined(&sensor, &status, 1);
+    return status;
+}
+
+static uint16_t HDC1080_start(Sensor* sensor, uint8_t step) {
     I2CSensor* i2c_sensor = (I2CSensor*)sensor->instance;
 
-    uint8_t data[2] = {0};
-    //Starting a measurement
-    if(!unitemp_i2c_write_array(i2c_sensor, 1, data)) return UT_SENSORSTATUS_TIMEOUT;
-    furi_delay_ms(10);
-    if(!unitemp_i2c_read_array(i2c_sensor, 2, data)) return UT_SENSORSTATUS_TIMEOUT;
+    //Starting a measurement: temperature register at step 0, humidity register at step 1
+    uint8_t data[1] = {step};
+    if(!unitemp_i2c_write_array(i2c_sensor, 1, data)) return 0;
+    return 10;
+}
 
-    sensor->temperature = ((float)(((uint16_t)data[0] << 8) | data[1]) / 65536) * 165 - 40;
+static SensorStatus HDC1080_read(Sensor* sensor, uint8_t step) {
+    I2CSensor* i2c_sensor = (I2CSensor*)sensor->instance;
 
-    data[0] = 1;
-    if(!unitemp_i2c_write_array(i2c_sensor, 1, data)) return UT_SENSORSTATUS_TIMEOUT;
-    furi_delay_ms(10);
+    uint8_t data[2] = {0};
     if(!unitemp_i2c_read_array(i2c_sensor, 2, data)) return UT_SENSORSTATUS_TIMEOUT;
-    sensor->humidity = ((float)(((uint16_t)data[0] << 8) | data[1]) / 65536) * 100;
+    float value = (float)(((uint16_t)data[0] << 8) | data[1]) / 65536;
+
+    if(step == 0) {
+        sensor->temperature = value * 165 - 40;
+        //Humidity is measured at the next step
+        return UT_SENSORSTATUS_POLLING;
+    }
+    sensor->humidity = value * 100;
 
     return UT_SENSORSTATUS_OK;
 }
@@ -17,6 +17,7 @@
 */
 #include "HTU21x.h"
 #include "../interfaces/i2c_sensor.h"
+#include "../helpers/unitemp_crc.h"
 
 const SensorModel HTU21x = {
     .modelname = "HTU21x",
@@ -51,16 +52,6 @@ const SensorModel SHT2x = {
     .deinitializer = unitemp_HTU21x_deinit,
     .updater = unitemp_HTU21x_update};
 
-static uint8_t checkCRC(uint16_t data) {
-    for(uint8_t i = 0; i < 16; i++) {
-        if(data & 0x8000)
-            data = (data << 1) ^ 0x13100;
-        else
-            data <<= 1;
-    }
-    return (data >> 8);
-}
-
 bool unitemp_HTU21x_alloc(Sensor* sensor, char* args) {
     UNUSED(args);
     I2CSensor* i2c_sensor = (I2CSensor*)sensor->instance;
@@ -115,7 +106,7 @@ SensorStatus unitemp_HTU21x_update(Sensor* sensor) {
         if(!unitemp_i2c_read_array(i2c_sensor, 3, data)) return UT_SENSORSTATUS_TIMEOUT;
 
         uint16_t raw = ((uint16_t)data[0] << 8) | data[1];
-        if(checkCRC(raw) != data[2]) return UT_SENSORSTATUS_BADCRC;
+        if(unitemp_crc8_htu(data, 2) != data[2]) return UT_SENSORSTATUS_BADCRC;
 
         if(temp_hum) {
             sensor->temperature = (0.002681f * raw - 46.85f);
@@ -29,21 +29,74 @@ const SensorModel MAX31855 = {
     .deinitializer = unitemp_MAX31855_deinit,
     .updater = unitemp_MAX31855_update};
 
+//NIST ITS-90 type K thermoelectric voltage (uV) from -200 to 1350 °C in 10 °C steps.
+//Linear interpolation between the points stays within 0.15 °C of the reference polynomial
+static const int32_t MAX31855_type_k_uv[] = {
+    -5891, -5730, -5550, -5354, -5141, -4913, -4669, -4411,
+    -4138, -3852, -3554, -3243, -2920, -2587, -2243, -1889,
+    -1527, -1156, -778, -392, 0, 397, 798, 1203,
+    1612, 2023, 2436, 2851, 3267, 3682, 4096, 4509,
+    4920, 5328, 5735, 6138, 6540, 6941, 7340, 7739,
+    8138, 8539, 8940, 9343, 9747, 10153, 10561, 10971,
+    11382, 11795, 12209, 12624, 13040, 13457, 13874, 14293,
+    14713, 15133, 15554, 15975, 16397, 16820, 17243, 17667,
+    18091, 18516, 18941, 19366, 19792, 20218, 20644, 21071,
+    21497, 21924, 22350, 22776, 23203, 23629, 24055, 24480,
+    24905, 25330, 25755, 26179, 26602, 27025, 27447, 27869,
+    28289, 28710, 29129, 29548, 29965, 30382, 30798, 31213,
+    31628, 32041, 32453, 32865, 33275, 33685, 34093, 34501,
+    34908, 35313, 35718, 36121, 36524, 36925, 37326, 37725,
+    38124, 38522, 38918, 39314, 39708, 40101, 40494, 40885,
+    41276, 41665, 42053, 42440, 42826, 43211, 43595, 43978,
+    44359, 44740, 45119, 45497, 45873, 46249, 46623, 46995,
+    47367, 47737, 48105, 48473, 48838, 49202, 49565, 49926,
+    50286, 50644, 51000, 51355, 51708, 52060, 52410, 52759,
+    53106, 53451, 53795, 54138
+};
+#define MAX31855_TYPE_K_MIN  (-200)
+#define MAX31855_TYPE_K_STEP 10
+#define MAX31855_TYPE_K_SIZE COUNT_OF(MAX31855_type_k_uv)
+//Constant type K sensitivity used by the chip for the conversion, uV/°C
+#define MAX31855_SEEBECK_UV 41.276f
+
+//NIST correction of the temperature
+static bool MAX31855_linearization = false;
+
+static SensorStatus MAX31855_decode(Sensor* sensor, const uint8_t* frame);
+
+void unitemp_MAX31855_set_linearization(bool enabled) {
+    MAX31855_linearization = enabled;
+}
+
 bool unitemp_MAX31855_alloc(Sensor* sensor, char* args) {
-    UNUSED(sensor);
     UNUSED(args);
+    SPISensor* instance = sensor->instance;
+
+    //32-bit frame read in a batch with the other thermocouples
+    instance->frame_size = 4;
+    instance->decode = MAX31855_decode;
+    //The fast capture polls the sensor with its maximum conversion time
+    instance->conversion_time = 100;
+
+    MAX31855_instance* max31855 = malloc(sizeof(MAX31855_instance));
+    if(max31855 == NULL) {
+        FURI_LOG_E(APP_NAME, "Sensor %s instance allocation error", sensor->name);
+        return false;
+    }
+    max31855->cold_junction = 0.0f;
+    max31855->fault = 0;
+    instance->sensor_instance = max31855;
     return true;
 }
 
 bool unitemp_MAX31855_free(Sensor* sensor) {
-    UNUSED(sensor);
+    SPISensor* instance = sensor->instance;
+    free(instance->sensor_instance);
     return true;
 }
 
 bool unitemp_MAX31855_init(Sensor* sensor) {
-    SPISensor* instance = sensor->instance;
-    furi_hal_spi_bus_handle_init(instance->spi);
-    UNUSED(instance);
+    unitemp_spi_sensor_cs_init(sensor->instance);
     return true;
 }
 
@@ -53,43 +106,87 @@ bool unitemp_MAX31855_deinit(Sensor* sensor) {
 }
 
 SensorStatus unitemp_MAX31855_update(Sensor* sensor) {
-    SPISensor* instance = sensor->instance;
-
-    furi_hal_spi_acquire(instance->spi);
-    furi_hal_gpio_write(instance->cs_pin->pin, false);
+    SensorStatus status;
+    unitemp_spi_sensors_update_batched(&sensor, &status, 1);
+    return status;
+}
 
-    uint8_t buff[4] = {0};
+/**
+ * @brief Type K thermoelectric voltage by the interpolated NIST table
+ * @param temperature Junction temperature, °C
+ * @return Voltage, uV
+ */
+static float MAX31855_type_k_voltage(float temperature) {
+    float position = (temperature - MAX31855_TYPE_K_MIN) / MAX31855_TYPE_K_STEP;
+    //Out of the table the edge segments are extrapolated
+    uint8_t index = 0;
+    if(position > 0.0f) index = (uint8_t)MIN(position, MAX31855_TYPE_K_SIZE - 2.0f);
+    int32_t segment = MAX31855_type_k_uv[index + 1] - MAX31855_type_k_uv[index];
+    return MAX31855_type_k_uv[index] + (position - index) * segment;
+}
 
-    furi_hal_spi_bus_rx(instance->spi, buff, 4, 0xFF);
-    furi_hal_gpio_write(instance->cs_pin->pin, true);
-    furi_hal_spi_release(instance->spi);
+/**
+ * @brief Temperature by the type K thermoelectric voltage from the interpolated NIST table
+ * @param voltage Voltage, uV
+ * @return Junction temperature, °C
+ */
+static float MAX31855_type_k_temperature(float voltage) {
+    //Binary search for the segment, out of the table the edge segments are extrapolated
+    uint8_t low = 0;
+    uint8_t high = MAX31855_TYPE_K_SIZE - 1;
+    while(high - low > 1) {
+        uint8_t middle = (low + high) / 2;
+        if(voltage < MAX31855_type_k_uv[middle]) {
+            high = middle;
+        } else {
+            low = middle;
+        }
+    }
+    return MAX31855_TYPE_K_MIN + low * MAX31855_TYPE_K_STEP +
+           (voltage - MAX31855_type_k_uv[low]) * MAX31855_TYPE_K_STEP /
+               (MAX31855_type_k_uv[high] - MAX31855_type_k_uv[low]);
+}
 
-    uint32_t raw = (buff[0] << 24) | (buff[1] << 16) | (buff[2] << 8) | buff[3];
+static SensorStatus MAX31855_decode(Sensor* sensor, const uint8_t* frame) {
+    MAX31855_instance* max31855 = ((SPISensor*)sensor->instance)->sensor_instance;
+    uint32_t raw = (frame[0] << 24) | (frame[1] << 16) | (frame[2] << 8) | frame[3];
 
     if(raw == 0xFFFFFFFF || raw == 0) return UT_SENSORSTATUS_TIMEOUT;
 
+    //The internal temperature is measured even when the thermocouple has a fault
+    max31855->cold_junction = (float)(int16_t)(raw & 0xFFF0) / 256.0f;
+
     //Determining the status of the thermocouple
-    uint8_t state = raw & 0b111;
-    //Break
-    if(state == 0x01) {
-        UNITEMP_DEBUG("%s has thermocouple open circuit", sensor->name);
-        return UT_SENSORSTATUS_ERROR;
-    }
-    //Short circuit to ground
-    if(state == 0x02) {
-        UNITEMP_DEBUG("%s has thermocouple short to GND", sensor->name);
-        return UT_SENSORSTATUS_ERROR;
-    }
-    //Short circuit to power
-    if(state == 0x04) {
-        UNITEMP_DEBUG("%s has thermocouple short to VCC", sensor->name);
-        return UT_SENSORSTATUS_ERROR;
+    max31855->fault = raw & 0b111;
+    if(raw & (1 << 16)) {
+        //Break
+        if(max31855->fault & MAX31855_FAULT_OC) {
+            UNITEMP_DEBUG("%s has thermocouple open circuit", sensor->name);
+        }
+        //Short circuit to ground
+        if(max31855->fault & MAX31855_FAULT_SCG) {
+            UNITEMP_DEBUG("%s has thermocouple short to GND", sensor->name);
+        }
+        //Short circuit to power
+        if(max31855->fault & MAX31855_FAULT_SCV) {
+            UNITEMP_DEBUG("%s has thermocouple short to VCC", sensor->name);
+        }
+        //The frame of a faulty thermocouple is not displayed
+        return UT_SENSORSTATUS_FAULT;
     }
 
     uint16_t temp_raw = (raw >> 16) & 0xFFFC;
     int16_t signed_temp_raw = (int16_t)temp_raw;
-
-    sensor->temperature = (float)signed_temp_raw / 16.0f;
+    float hot_junction = (float)signed_temp_raw / 16.0f;
+
+    if(MAX31855_linearization) {
+        //Thermocouple voltage the chip has converted with the constant sensitivity
+        float voltage = (hot_junction - max31855->cold_junction) * MAX31855_SEEBECK_UV;
+        //Cold junction compensation by the real curve
+        voltage += MAX31855_type_k_voltage(max31855->cold_junction);
+        hot_junction = MAX31855_type_k_temperature(voltage);
+    }
+    sensor->temperature = hot_junction;
 
     return UT_SENSORSTATUS_OK;
 }
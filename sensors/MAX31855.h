@@ -22,6 +22,18 @@
 #include "../sensors.h"
 #include "../interfaces/spi_sensor.h"
 
+//Fault bits of the MAX31855 frame
+#define MAX31855_FAULT_OC  0x01 //Thermocouple open circuit
+#define MAX31855_FAULT_SCG 0x02 //Thermocouple short to GND
+#define MAX31855_FAULT_SCV 0x04 //Thermocouple short to VCC
+
+typedef struct {
+    //Internal (cold junction) temperature, °C
+    float cold_junction;
+    //Fault bits of the last frame, 0 if the thermocouple is fine
+    uint8_t fault;
+} MAX31855_instance;
+
 extern const SensorModel MAX31855;
 
 /**
@@ -62,4 +74,13 @@ SensorStatus unitemp_MAX31855_update(Sensor* sensor);
  */
 bool unitemp_MAX31855_free(Sensor* sensor);
 
+/**
+ * @brief Enable the NIST ITS-90 correction of the thermocouple temperature
+ *
+ * The chip converts the voltage with a constant type K sensitivity, which
+ * drifts from the real curve by several degrees at high and low temperatures.
+ * @param enabled True to correct the temperature with the NIST table
+ */
+void unitemp_MAX31855_set_linearization(bool enabled);
+
 #endif
@@ -29,9 +29,17 @@ const SensorModel MAX6675 = {
     .deinitializer = unitemp_MAX6675_deinit,
     .updater = unitemp_MAX6675_update};
 
+static SensorStatus MAX6675_decode(Sensor* sensor, const uint8_t* frame);
+
 bool unitemp_MAX6675_alloc(Sensor* sensor, char* args) {
-    UNUSED(sensor);
     UNUSED(args);
+    SPISensor* instance = sensor->instance;
+
+    //16-bit frame read in a batch with the other thermocouples
+    instance->frame_size = 2;
+    instance->decode = MAX6675_decode;
+    //The fast capture polls the sensor with its maximum conversion time
+    instance->conversion_time = 220;
     return true;
 }
 
@@ -41,9 +49,7 @@ bool unitemp_MAX6675_free(Sensor* sensor) {
 }
 
 bool unitemp_MAX6675_init(Sensor* sensor) {
-    SPISensor* instance = sensor->instance;
-    furi_hal_spi_bus_handle_init(instance->spi);
-    UNUSED(instance);
+    unitemp_spi_sensor_cs_init(sensor->instance);
     return true;
 }
 
@@ -53,18 +59,13 @@ bool unitemp_MAX6675_deinit(Sensor* sensor) {
 }
 
 SensorStatus unitemp_MAX6675_update(Sensor* sensor) {
-    SPISensor* instance = sensor->instance;
-
-    furi_hal_spi_acquire(instance->spi);
-    furi_hal_gpio_write(instance->cs_pin->pin, false);
-
-    uint8_t buff[2] = {0};
-    furi_hal_spi_bus_rx(instance->spi, buff, 2, 0xFF);
-
-    furi_hal_gpio_write(instance->cs_pin->pin, true);
-    furi_hal_spi_release(instance->spi);
+    SensorStatus status;
+    unitemp_spi_sensors_update_batched(&sensor, &status, 1);
+    return status;
+}
 
-    uint16_t raw = (buff[0] << 8) | buff[1];
+static SensorStatus MAX6675_decode(Sensor* sensor, const uint8_t* frame) {
+    uint16_t raw = (frame[0] << 8) | frame[1];
 
     if(raw == 0xFFFF || raw == 0) return UT_SENSORSTATUS_TIMEOUT;
 
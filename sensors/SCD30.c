@@ -22,6 +22,7 @@
 #include "SCD30.h"
 #include "../interfaces/i2c_sensor.h"
 #include "../helpers/endianness.h"
+#include "../helpers/unitemp_crc.h"
 
 const SensorModel SCD30 = {
     .modelname = "SCD30",
@@ -42,6 +43,7 @@ typedef union {
 
 #define SCD30_I2C_ADDRESS           0x61
 #define SCD30_I2C_CMD_TIMEOUT       5 // must be bigger than 3 ms
+#define SCD30_CLOCK_STRETCH_MS      150 //Up to 150 ms during internal calibration
 #define SCD30_PRESSURE_COMPENSATION 0 //Range 700-1400 mBar. 0 deactivates pressure compensation
 #define SCD30_MEASUREMENT_INTERVAL  2 //Range 2-1800 sec
 
@@ -62,7 +64,6 @@ typedef union {
 
 static bool _send_cmd(Sensor* sensor, uint16_t cmd);
 static bool _send_cmd_arg_crc(Sensor* sensor, uint16_t cmd, uint16_t arg);
-static uint8_t _compute_crc8(uint8_t* message, uint8_t len);
 
 bool scd30_reset(Sensor* sensor);
 bool scd30_read_fw_version(Sensor* sensor, uint8_t* major, uint8_t* minor);
@@ -80,6 +81,7 @@ bool unitemp_SCD30_alloc(Sensor* sensor, char* args) {
 
     i2c_sensor->min_i2c_adress = SCD30_I2C_ADDRESS << 1;
     i2c_sensor->max_i2c_adress = SCD30_I2C_ADDRESS << 1;
+    i2c_sensor->clock_stretch_ms = SCD30_CLOCK_STRETCH_MS;
     return true;
 }
 
@@ -130,7 +132,7 @@ static bool _send_cmd_arg_crc(Sensor* sensor, uint16_t cmd, uint16_t arg) {
     I2CSensor* i2c_sensor = (I2CSensor*)sensor->instance;
 
     uint8_t buff[5] = {cmd >> 8, cmd, arg >> 8, arg};
-    uint8_t crc = _compute_crc8(buff + 2, 2);
+    uint8_t crc = unitemp_crc8_sensirion(buff + 2, 2);
     buff[4] = crc;
 
     return unitemp_i2c_write_array(i2c_sensor, 5, buff);
@@ -143,30 +145,17 @@ static uint16_t _read_reg(Sensor* sensor, uint16_t cmd) {
 
     uint8_t buff[3];
     if(!unitemp_i2c_read_array(i2c_sensor, 3, buff)) return 0xFFFF;
-    if(buff[2] != _compute_crc8(buff, 2)) return 0xFFFF;
+    if(buff[2] != unitemp_crc8_sensirion(buff, 2)) return 0xFFFF;
 
     return (buff[0] << 8) | buff[1];
 }
-static uint8_t _compute_crc8(uint8_t* message, uint8_t len) {
-    uint8_t crc = 0xFF; // Init with 0xFF
-    for(uint8_t x = 0; x < len; x++) {
-        crc ^= message[x]; // XOR-in the next input byte
-        for(uint8_t i = 0; i < 8; i++) {
-            if((crc & 0x80) != 0)
-                crc = (uint8_t)((crc << 1) ^ 0x31);
-            else
-                crc <<= 1;
-        }
-    }
-    return crc; // No output reflection
-}
 static bool _load_float(uint8_t* buff, float* val) {
     size_t cntr = 0;
     uint8_t floatBuff[4];
     for(size_t i = 0; i < 2; i++) {
         floatBuff[cntr++] = buff[0];
         floatBuff[cntr++] = buff[1];
-        uint8_t expectedCRC = _compute_crc8(buff, 2);
+        uint8_t expectedCRC = unitemp_crc8_sensirion(buff, 2);
         if(buff[2] != expectedCRC) return false;
         buff += 3;
     }
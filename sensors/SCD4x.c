@@ -18,6 +18,7 @@
 
 #include "SCD4x.h"
 #include "../interfaces/i2c_sensor.h"
+#include "../helpers/unitemp_crc.h"
 
 const SensorModel SCD4x = {
     .modelname = "SCD4x",
@@ -65,7 +66,6 @@ bool SCD4x_get_data_ready_status(Sensor* sensor);
 uint64_t SCD4x_get_serial_number(Sensor* sensor);
 
 static bool _send_cmd(Sensor* sensor, uint16_t cmd);
-static uint8_t _compute_crc8(uint8_t* message, uint8_t len);
 //static bool _send_cmd_arg_crc(Sensor* sensor, uint16_t cmd, uint16_t arg);
 
 bool unitemp_SCD4x_alloc(Sensor* sensor, char* args) {
@@ -103,20 +103,6 @@ SensorStatus unitemp_SCD4x_update(Sensor* sensor) {
     return SCD4x_read_measurement(sensor) ? UT_SENSORSTATUS_OK : UT_SENSORSTATUS_TIMEOUT;
 }
 
-static uint8_t _compute_crc8(uint8_t* message, uint8_t len) {
-    uint8_t crc = 0xFF; // Init with 0xFF
-    for(uint8_t x = 0; x < len; x++) {
-        crc ^= message[x]; // XOR-in the next input byte
-        for(uint8_t i = 0; i < 8; i++) {
-            if((crc & 0x80) != 0)
-                crc = (uint8_t)((crc << 1) ^ 0x31);
-            else
-                crc <<= 1;
-        }
-    }
-    return crc; // No output reflection
-}
-
 static bool _send_cmd(Sensor* sensor, uint16_t cmd) {
     I2CSensor* i2c_sensor = sensor->instance;
     uint8_t buff[2] = {cmd >> 8, cmd & 0x00FF};
@@ -127,7 +113,7 @@ static bool _send_cmd(Sensor* sensor, uint16_t cmd) {
 //     I2CSensor* i2c_sensor = (I2CSensor*)sensor->instance;
 
 //     uint8_t buff[5] = {cmd >> 8, cmd, arg >> 8, arg};
-//     uint8_t crc = _compute_crc8(buff + 2, 2);
+//     uint8_t crc = unitemp_crc8_sensirion(buff + 2, 2);
 //     buff[4] = crc;
 
 //     return unitemp_i2c_write_array(i2c_sensor, 5, buff);
@@ -149,9 +135,9 @@ bool SCD4x_read_measurement(Sensor* sensor) {
     if(!unitemp_i2c_read_array(i2c_sensor, 9, buff)) return false;
 
     //Checking CRC
-    if(_compute_crc8(buff + 0, 2) != buff[2]) return false;
-    if(_compute_crc8(buff + 3, 2) != buff[5]) return false;
-    if(_compute_crc8(buff + 6, 2) != buff[8]) return false;
+    if(unitemp_crc8_sensirion(buff + 0, 2) != buff[2]) return false;
+    if(unitemp_crc8_sensirion(buff + 3, 2) != buff[5]) return false;
+    if(unitemp_crc8_sensirion(buff + 6, 2) != buff[8]) return false;
 
     //Converting values
     sensor->co2 = (buff[0] << 8) | buff[1];
@@ -175,7 +161,7 @@ bool SCD4x_get_data_ready_status(Sensor* sensor) {
 
     uint8_t buff[3] = {0};
     if(!unitemp_i2c_read_array(i2c_sensor, 3, buff)) return false;
-    if(_compute_crc8(buff + 0, 2) != buff[2]) return false;
+    if(unitemp_crc8_sensirion(buff + 0, 2) != buff[2]) return false;
 
     uint16_t responce = ((uint16_t)buff[0] << 8) | buff[1];
     if((responce & 0x8000) != 0x8000) return false; //wrong responce
@@ -193,9 +179,9 @@ uint64_t SCD4x_get_serial_number(Sensor* sensor) {
     unitemp_i2c_read_array(i2c_sensor, 9, buff);
 
     //Checking CRC
-    if(_compute_crc8(buff + 0, 2) != buff[2]) return 0;
-    if(_compute_crc8(buff + 3, 2) != buff[5]) return 0;
-    if(_compute_crc8(buff + 6, 2) != buff[8]) return 0;
+    if(unitemp_crc8_sensirion(buff + 0, 2) != buff[2]) return 0;
+    if(unitemp_crc8_sensirion(buff + 3, 2) != buff[5]) return 0;
+    if(unitemp_crc8_sensirion(buff + 6, 2) != buff[8]) return 0;
 
     uint16_t fw = ((uint16_t)buff[0] << 8) | buff[1];
     uint16_t sw = ((uint16_t)buff[3] << 8) | buff[4];
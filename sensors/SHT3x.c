@@ -17,6 +17,7 @@
 */
 #include "SHT3x.h"
 #include "../interfaces/i2c_sensor.h"
+#include "../helpers/unitemp_crc.h"
 
 const SensorModel SHT3x = {
     .modelname = "SHT3x",
@@ -57,24 +58,6 @@ bool unitemp_SHT3x_I2C_free(Sensor* sensor) {
     return true;
 }
 
-static uint8_t unitemp_SHT3x_crc8(const uint8_t* data, const size_t len) {
-    // From Sensirion application note: polynomial 0x31, init 0xFF
-    uint8_t crc = 0xFF;
-
-    for(size_t byte = 0; byte < len; ++byte) {
-        crc ^= data[byte];
-        for(uint8_t bit = 0; bit < 8; ++bit) {
-            if(crc & 0x80) {
-                crc = (crc << 1) ^ 0x31;
-            } else {
-                crc = (crc << 1);
-            }
-        }
-    }
-
-    return crc;
-}
-
 static bool unitemp_SHT3x_readSerial(I2CSensor* i2c_sensor, uint32_t* serial) {
     // Read 32-bit unique serial number; does not encode the exact SHT3x variant
     uint8_t command[2] = {0x37, 0x80};
@@ -84,8 +67,8 @@ static bool unitemp_SHT3x_readSerial(I2CSensor* i2c_sensor, uint32_t* serial) {
     furi_delay_ms(1);
     if(!unitemp_i2c_read_array(i2c_sensor, 6, response)) return false;
 
-    if(unitemp_SHT3x_crc8(response, 2) != response[2]) return false;
-    if(unitemp_SHT3x_crc8(&response[3], 2) != response[5]) return false;
+    if(unitemp_crc8_sensirion(response, 2) != response[2]) return false;
+    if(unitemp_crc8_sensirion(&response[3], 2) != response[5]) return false;
 
     if(serial) {
         *serial = ((uint32_t)response[0] << 24) | ((uint32_t)response[1] << 16) |
@@ -17,6 +17,7 @@
 */
 #include "SHT4x.h"
 #include "../interfaces/i2c_sensor.h"
+#include "../helpers/unitemp_crc.h"
 
 #define COMMAND_SOFT_RESET                   0x94
 #define COMMAND_READ_SN                      0x89
@@ -24,7 +25,8 @@
 
 bool SHT4x_soft_reset(Sensor* sensor);
 uint32_t SHT4x_read_serial_number(Sensor* sensor);
-bool SHT4x_read_th(Sensor* sensor);
+static uint16_t SHT4x_start_th(Sensor* sensor, uint8_t step);
+static SensorStatus SHT4x_read_th(Sensor* sensor, uint8_t step);
 
 const SensorModel SHT4x = {
     .modelname = "SHT4x",
@@ -45,6 +47,10 @@ bool unitemp_SHT4x_alloc(Sensor* sensor, char* args) {
     //Addresses on the I2C bus (7 bits)
     i2c_sensor->min_i2c_adress = 0x44 << 1;
     i2c_sensor->max_i2c_adress = 0x46 << 1;
+
+    //Measurement split for the pipelined poll
+    i2c_sensor->pipeline_start = SHT4x_start_th;
+    i2c_sensor->pipeline_read = SHT4x_read_th;
     return true;
 }
 
@@ -71,26 +77,9 @@ bool unitemp_SHT4x_deinit(Sensor* sensor) {
 }
 
 SensorStatus unitemp_SHT4x_update(Sensor* sensor) {
-    if(!SHT4x_read_th(sensor)) return UT_SENSORSTATUS_TIMEOUT;
-    return UT_SENSORSTATUS_OK;
-}
-
-uint8_t SHT4x_crc8(const uint8_t* data, const size_t len) {
-    // From Sensirion application note: polynomial 0x31, init 0xFF
-    uint8_t crc = 0xFF;
-
-    for(size_t byte = 0; byte < len; ++byte) {
-        crc ^= data[byte];
-        for(uint8_t bit = 0; bit < 8; ++bit) {
-            if(crc & 0x80) {
-                crc = (crc << 1) ^ 0x31;
-            } else {
-                crc = (crc << 1);
-            }
-        }
-    }
-
-    return crc;
+    SensorStatus status;
+    unitemp_i2c_sensors_update_pipelined(&sensor, &status, 1);
+    return status;
 }
 
 bool SHT4x_soft_reset(Sensor* sensor) {
@@ -106,24 +95,32 @@ uint32_t SHT4x_read_serial_number(Sensor* sensor) {
     if(!unitemp_i2c_write_array(i2c_sensor, 1, buff)) return 0;
     furi_delay_ms(1);
     if(!unitemp_i2c_read_array(i2c_sensor, 6, buff)) return 0;
-    if(SHT4x_crc8(buff, 2) != buff[2]) return 0;
-    if(SHT4x_crc8(buff + 3, 2) != buff[5]) return 0;
+    if(unitemp_crc8_sensirion(buff, 2) != buff[2]) return 0;
+    if(unitemp_crc8_sensirion(buff + 3, 2) != buff[5]) return 0;
 
     return ((uint32_t)buff[0] << 24) | ((uint32_t)buff[1] << 16) | ((uint32_t)buff[3] << 8) |
            buff[4];
 }
 
-bool SHT4x_read_th(Sensor* sensor) {
+static uint16_t SHT4x_start_th(Sensor* sensor, uint8_t step) {
+    UNUSED(step);
     I2CSensor* i2c_sensor = (I2CSensor*)sensor->instance;
 
-    uint8_t buff[6] = {COMMAND_MEASURE_WITH_HIGHT_PRECISION};
-    if(!unitemp_i2c_write_array(i2c_sensor, 1, buff)) return false;
-    furi_delay_ms(9);
+    uint8_t buff[1] = {COMMAND_MEASURE_WITH_HIGHT_PRECISION};
+    if(!unitemp_i2c_write_array(i2c_sensor, 1, buff)) return 0;
+    //High precision measurement time
+    return 9;
+}
+
+static SensorStatus SHT4x_read_th(Sensor* sensor, uint8_t step) {
+    UNUSED(step);
+    I2CSensor* i2c_sensor = (I2CSensor*)sensor->instance;
 
-    if(!unitemp_i2c_read_array(i2c_sensor, 6, buff)) return false;
+    uint8_t buff[6] = {0};
+    if(!unitemp_i2c_read_array(i2c_sensor, 6, buff)) return UT_SENSORSTATUS_TIMEOUT;
 
-    if(SHT4x_crc8(buff, 2) != buff[2]) return false;
-    if(SHT4x_crc8(buff + 3, 2) != buff[5]) return false;
+    if(unitemp_crc8_sensirion(buff, 2) != buff[2]) return UT_SENSORSTATUS_BADCRC;
+    if(unitemp_crc8_sensirion(buff + 3, 2) != buff[5]) return UT_SENSORSTATUS_BADCRC;
 
     uint16_t t = (buff[0] << 8) | buff[1];
     sensor->temperature = -45.0f + 175.0f * t / 65535.0f;
@@ -133,5 +130,5 @@ bool SHT4x_read_th(Sensor* sensor) {
     if(sensor->humidity > 100) sensor->humidity = 100.0f;
     if(sensor->humidity < 0) sensor->humidity = 0.0f;
 
-    return true;
+    return UT_SENSORSTATUS_OK;
 }
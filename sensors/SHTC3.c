@@ -18,6 +18,7 @@
 
 #include "SHTC3.h"
 #include "../interfaces/i2c_sensor.h"
+#include "../helpers/unitemp_crc.h"
 
 #define SHTC3_COMMAND_SLEEP                        0xB098
 #define SHTC3_COMMAND_WAKEUP                       0x3517
@@ -32,7 +33,8 @@ static bool SHTC3_wakeup(I2CSensor* sensor);
 static bool SHTC3_sleep(I2CSensor* sensor);
 
 static uint16_t SHTC3_read_serial_number(I2CSensor* sensor);
-static uint8_t unitemp_SHTC3_crc8(const uint8_t* data, const size_t len);
+static uint16_t SHTC3_start(Sensor* sensor, uint8_t step);
+static SensorStatus SHTC3_read(Sensor* sensor, uint8_t step);
 
 const SensorModel SHTC3 = {
     .modelname = "SHTC3",
@@ -52,6 +54,10 @@ bool unitemp_SHTC3_I2C_alloc(Sensor* sensor, char* args) {
     //Адреса на шине I2C (7 бит)
     i2c_sensor->min_i2c_adress = 0x70 << 1;
     i2c_sensor->max_i2c_adress = 0x70 << 1;
+
+    //Measurement split for the pipelined poll
+    i2c_sensor->pipeline_start = SHTC3_start;
+    i2c_sensor->pipeline_read = SHTC3_read;
     return true;
 }
 
@@ -80,17 +86,28 @@ bool unitemp_SHTC3_I2C_deinit(Sensor* sensor) {
 }
 
 SensorStatus unitemp_SHTC3_I2C_update(Sensor* sensor) {
+    SensorStatus status;
+    unitemp_i2c_sensors_update_pipelined(&sensor, &status, 1);
+    return status;
+}
+
+static uint16_t SHTC3_start(Sensor* sensor, uint8_t step) {
+    UNUSED(step);
     I2CSensor* i2c_sensor = (I2CSensor*)sensor->instance;
 
-    if(!SHTC3_send_cmd(i2c_sensor, SHTC3_COMMAND_MEASUREMENT_NORMAL_READ_TEMP))
-        return UT_SENSORSTATUS_TIMEOUT;
-    furi_delay_ms(13); //meauserement timeout
+    if(!SHTC3_send_cmd(i2c_sensor, SHTC3_COMMAND_MEASUREMENT_NORMAL_READ_TEMP)) return 0;
+    return 13; //meauserement timeout
+}
+
+static SensorStatus SHTC3_read(Sensor* sensor, uint8_t step) {
+    UNUSED(step);
+    I2CSensor* i2c_sensor = (I2CSensor*)sensor->instance;
 
     uint8_t buff[6] = {0};
     if(!unitemp_i2c_read_array(i2c_sensor, 6, buff)) return UT_SENSORSTATUS_TIMEOUT;
 
-    if(unitemp_SHTC3_crc8(buff, 2) != buff[2]) return UT_SENSORSTATUS_BADCRC;
-    if(unitemp_SHTC3_crc8(buff + 3, 2) != buff[5]) return UT_SENSORSTATUS_BADCRC;
+    if(unitemp_crc8_sensirion(buff, 2) != buff[2]) return UT_SENSORSTATUS_BADCRC;
+    if(unitemp_crc8_sensirion(buff + 3, 2) != buff[5]) return UT_SENSORSTATUS_BADCRC;
 
     uint32_t temp = 175 * ((uint16_t)(buff[0] << 8) | buff[1]);
     uint32_t hum = 100 * ((uint16_t)(buff[3] << 8) | buff[4]);
@@ -132,20 +149,3 @@ static bool SHTC3_sleep(I2CSensor* sensor) {
     return SHTC3_send_cmd(sensor, SHTC3_COMMAND_SLEEP);
 }
 
-static uint8_t unitemp_SHTC3_crc8(const uint8_t* data, const size_t len) {
-    // From Sensirion application note: polynomial 0x31, init 0xFF
-    uint8_t crc = 0xFF;
-
-    for(size_t byte = 0; byte < len; ++byte) {
-        crc ^= data[byte];
-        for(uint8_t bit = 0; bit < 8; ++bit) {
-            if(crc & 0x80) {
-                crc = (crc << 1) ^ 0x31;
-            } else {
-                crc = (crc << 1);
-            }
-        }
-    }
-
-    return crc;
-}
@@ -0,0 +1,74 @@
+/*
+    Unitemp - Universal temperature reader
+    Copyright (C) 2022-2026  Victor Nikitchuk (https://github.com/quen0n)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "Virtual.h"
+
+const SensorModel VirtT = {
+    .modelname = "VirtT",
+    .altname = "Virtual T",
+    .interface = &unitemp_virtual,
+    .data_type = UT_DATA_TYPE_TEMP,
+    .polling_interval = 1000,
+    .allocator = unitemp_virtual_alloc,
+    .mem_releaser = unitemp_virtual_free,
+    .initializer = unitemp_virtual_init,
+    .deinitializer = unitemp_virtual_deinit,
+    .updater = unitemp_virtual_update};
+const SensorModel VirtTH = {
+    .modelname = "VirtTH",
+    .altname = "Virtual T+H",
+    .interface = &unitemp_virtual,
+    .data_type = UT_DATA_TYPE_TEMP_HUM,
+    .polling_interval = 1000,
+    .allocator = unitemp_virtual_alloc,
+    .mem_releaser = unitemp_virtual_free,
+    .initializer = unitemp_virtual_init,
+    .deinitializer = unitemp_virtual_deinit,
+    .updater = unitemp_virtual_update};
+const SensorModel VirtTP = {
+    .modelname = "VirtTP",
+    .altname = "Virtual T+P",
+    .interface = &unitemp_virtual,
+    .data_type = UT_DATA_TYPE_TEMP_PRESS,
+    .polling_interval = 1000,
+    .allocator = unitemp_virtual_alloc,
+    .mem_releaser = unitemp_virtual_free,
+    .initializer = unitemp_virtual_init,
+    .deinitializer = unitemp_virtual_deinit,
+    .updater = unitemp_virtual_update};
+const SensorModel VirtTHP = {
+    .modelname = "VirtTHP",
+    .altname = "Virtual T+H+P",
+    .interface = &unitemp_virtual,
+    .data_type = UT_DATA_TYPE_TEMP_HUM_PRESS,
+    .polling_interval = 1000,
+    .allocator = unitemp_virtual_alloc,
+    .mem_releaser = unitemp_virtual_free,
+    .initializer = unitemp_virtual_init,
+    .deinitializer = unitemp_virtual_deinit,
+    .updater = unitemp_virtual_update};
+const SensorModel VirtCO2 = {
+    .modelname = "VirtCO2",
+    .altname = "Virtual T+H+CO2",
+    .interface = &unitemp_virtual,
+    .data_type = UT_DATA_TYPE_TEMP_HUM_CO2,
+    .polling_interval = 1000,
+    .allocator = unitemp_virtual_alloc,
+    .mem_releaser = unitemp_virtual_free,
+    .initializer = unitemp_virtual_init,
+    .deinitializer = unitemp_virtual_deinit,
+    .updater = unitemp_virtual_update};
@@ -0,0 +1,32 @@
+/*
+    Unitemp - Universal temperature reader
+    Copyright (C) 2022-2026  Victor Nikitchuk (https://github.com/quen0n)
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#ifndef UNITEMP_VIRTUAL_MODELS
+#define UNITEMP_VIRTUAL_MODELS
+
+#include "../unitemp.h"
+#include "../sensors.h"
+#include "../interfaces/virtual_sensor.h"
+
+//Virtual sensors without hardware, one model per returned data type
+extern const SensorModel VirtT;
+extern const SensorModel VirtTH;
+extern const SensorModel VirtTP;
+extern const SensorModel VirtTHP;
+extern const SensorModel VirtCO2;
+
+#endif
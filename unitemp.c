@@ -24,6 +24,8 @@
 #include <core/kernel.h>
 #include <locale/locale.h>
 #include "flipper_format.h"
+#include "interfaces/onewire_sensor.h"
+#include "sensors/MAX31855.h"
 
 bool unitemp_custom_event_callback(void* context, uint32_t event) {
     furi_assert(context);
@@ -54,6 +56,24 @@ void unitemp_widget_callback(GuiButtonType result, InputType type, void* context
         view_dispatcher_send_custom_event(app->view_dispatcher, result);
     }
 }
+/**
+ * @brief Read an optional setting
+ * 
+ * The key search of flipper format only goes forward, so the file is rewound before
+ * every key and the keys can be read in any order.
+ * @param file Pointer to the settings file
+ * @param key Setting key
+ * @param default_value Value used if the key is missing
+ * @return Setting value
+ */
+static uint32_t
+    unitemp_settings_read_uint32(FlipperFormat* file, const char* key, uint32_t default_value) {
+    uint32_t value = default_value;
+    flipper_format_rewind(file);
+    if(!flipper_format_read_uint32(file, key, &value, 1)) value = default_value;
+    return value;
+}
+
 bool unitemp_settings_load(void* context) {
     if(context == NULL) return false;
 
@@ -77,39 +97,66 @@ bool unitemp_settings_load(void* context) {
     app->settings->otg_latest_state = power_is_otg_enabled(app->power);
     app->settings->environment_state_led_indication = true;
     app->settings->environment_state_sound_and_vibro_indication = true;
+    app->settings->i2c_pipelining = false;
+    app->settings->onewire_alarm_search = false;
+    app->settings->onewire_overdrive = false;
+    app->settings->singlewire_group = false;
+    app->settings->thermocouple_nist = false;
+    app->settings->bus_trace = UnitempTraceModeOff;
 
     bool result = false;
     FlipperFormat* file = flipper_format_file_alloc(app->storage);
 
-    uint32_t uint32_value = 1;
     FuriString* file_type;
     file_type = furi_string_alloc();
     do {
         if(!flipper_format_file_open_existing(file, APP_DATA_PATH(APP_SETTINGS_FILENAME))) break;
 
         // Reading settings from a file. If any key is not read, the default value will be used
-        flipper_format_read_uint32(file, "infinity_backlight", &uint32_value, 1);
-        app->settings->infinity_backlight = (bool)uint32_value;
-        flipper_format_read_uint32(file, "temperature_unit", &uint32_value, 1);
-        app->settings->temperature_unit = uint32_value;
-        flipper_format_read_uint32(file, "humidity_unit", &uint32_value, 1);
-        app->settings->humidity_unit = uint32_value;
-        flipper_format_read_uint32(file, "pressure_unit", &uint32_value, 1);
-        app->settings->pressure_unit = uint32_value;
-        flipper_format_read_uint32(file, "heat_index", &uint32_value, 1);
-        app->settings->heat_index = (bool)uint32_value;
-        flipper_format_read_uint32(file, "otg_auto_on", &uint32_value, 1);
-        app->settings->otg_auto_on = (bool)uint32_value;
-        flipper_format_read_uint32(file, "environment_state_led_indication", &uint32_value, 1);
-        app->settings->environment_state_led_indication = (bool)uint32_value;
-        flipper_format_read_uint32(
-            file, "environment_state_sound_and_vibro_indication", &uint32_value, 1);
-        app->settings->environment_state_sound_and_vibro_indication = (bool)uint32_value;
+        app->settings->infinity_backlight = unitemp_settings_read_uint32(
+            file, "infinity_backlight", app->settings->infinity_backlight);
+        app->settings->temperature_unit = unitemp_settings_read_uint32(
+            file, "temperature_unit", app->settings->temperature_unit);
+        app->settings->humidity_unit =
+            unitemp_settings_read_uint32(file, "humidity_unit", app->settings->humidity_unit);
+        app->settings->pressure_unit =
+            unitemp_settings_read_uint32(file, "pressure_unit", app->settings->pressure_unit);
+        app->settings->heat_index =
+            unitemp_settings_read_uint32(file, "heat_index", app->settings->heat_index);
+        app->settings->otg_auto_on =
+            unitemp_settings_read_uint32(file, "otg_auto_on", app->settings->otg_auto_on);
+        app->settings->environment_state_led_indication = unitemp_settings_read_uint32(
+            file,
+            "environment_state_led_indication",
+            app->settings->environment_state_led_indication);
+        app->settings->environment_state_sound_and_vibro_indication = unitemp_settings_read_uint32(
+            file,
+            "environment_state_sound_and_vibro_indication",
+            app->settings->environment_state_sound_and_vibro_indication);
+        app->settings->i2c_pipelining = unitemp_settings_read_uint32(
+            file, "i2c_pipelining", app->settings->i2c_pipelining);
+        app->settings->onewire_alarm_search = unitemp_settings_read_uint32(
+            file, "onewire_alarm_search", app->settings->onewire_alarm_search);
+        app->settings->onewire_overdrive = unitemp_settings_read_uint32(
+            file, "onewire_overdrive", app->settings->onewire_overdrive);
+        app->settings->singlewire_group = unitemp_settings_read_uint32(
+            file, "singlewire_group", app->settings->singlewire_group);
+        app->settings->thermocouple_nist = unitemp_settings_read_uint32(
+            file, "thermocouple_nist", app->settings->thermocouple_nist);
+        app->settings->bus_trace =
+            unitemp_settings_read_uint32(file, "bus_trace", UnitempTraceModeOff);
+        if(app->settings->bus_trace >= UnitempTraceModesCount) {
+            app->settings->bus_trace = UnitempTraceModeOff;
+        }
         result = true;
     } while(0);
 
     furi_string_free(file_type);
     flipper_format_free(file);
+    unitemp_onewire_set_alarm_search(app->settings->onewire_alarm_search);
+    unitemp_onewire_set_overdrive(app->settings->onewire_overdrive);
+    unitemp_MAX31855_set_linearization(app->settings->thermocouple_nist);
+    unitemp_trace_set_mode(app->settings->bus_trace);
     UNITEMP_DEBUG("Loading settings %s", result ? "success" : "failed");
 
     return result;
@@ -140,6 +187,25 @@ bool unitemp_settings_save(void* context) {
         if(!flipper_format_write_uint32(file, "heat_index", &buff, 1)) break;
         buff = app->settings->otg_auto_on;
         if(!flipper_format_write_uint32(file, "otg_auto_on", &buff, 1)) break;
+        buff = app->settings->environment_state_led_indication;
+        if(!flipper_format_write_uint32(file, "environment_state_led_indication", &buff, 1))
+            break;
+        buff = app->settings->environment_state_sound_and_vibro_indication;
+        if(!flipper_format_write_uint32(
+               file, "environment_state_sound_and_vibro_indication", &buff, 1))
+            break;
+        buff = app->settings->i2c_pipelining;
+        if(!flipper_format_write_uint32(file, "i2c_pipelining", &buff, 1)) break;
+        buff = app->settings->onewire_alarm_search;
+        if(!flipper_format_write_uint32(file, "onewire_alarm_search", &buff, 1)) break;
+        buff = app->settings->onewire_overdrive;
+        if(!flipper_format_write_uint32(file, "onewire_overdrive", &buff, 1)) break;
+        buff = app->settings->singlewire_group;
+        if(!flipper_format_write_uint32(file, "singlewire_group", &buff, 1)) break;
+        buff = app->settings->thermocouple_nist;
+        if(!flipper_format_write_uint32(file, "thermocouple_nist", &buff, 1)) break;
+        buff = app->settings->bus_trace;
+        if(!flipper_format_write_uint32(file, "bus_trace", &buff, 1)) break;
 
         result = true;
     } while(0);
@@ -31,6 +31,7 @@
 
 #include "scenes/unitemp_scene.h"
 #include "helpers/unitemp_utils.h"
+#include "helpers/unitemp_trace.h"
 
 #include "views/view_no_sensors.h"
 #include "views/view_single_sensor.h"
@@ -139,6 +140,18 @@ typedef struct {
     bool environment_state_led_indication;
     // Sound and vibro indication of the environment state
     bool environment_state_sound_and_vibro_indication;
+    // Pipelined poll of I2C sensors
+    bool i2c_pipelining;
+    // Alarm search mode of 1-Wire buses
+    bool onewire_alarm_search;
+    // Overdrive speed of 1-Wire devices
+    bool onewire_overdrive;
+    // Simultaneous frame capture of single-wire sensors
+    bool singlewire_group;
+    // NIST correction of thermocouple temperatures
+    bool thermocouple_nist;
+    // Record or replay of the bus transactions
+    UnitempTraceMode bus_trace;
 } UnitempSettings;
 
 typedef struct {
@@ -19,12 +19,15 @@
 #include "../unitemp.h"
 
 #include <gui/elements.h>
+#include <locale/locale.h>
 #include "view_single_sensor.h"
 
 #include "../interfaces/singlewire_sensor.h"
 #include "../interfaces/i2c_sensor.h"
 #include "../interfaces/spi_sensor.h"
 #include "../interfaces/onewire_sensor.h"
+#include "../interfaces/virtual_sensor.h"
+#include "../sensors/MAX31855.h"
 
 extern const Icon I_ButtonRight_4x7;
 extern const Icon I_ButtonLeft_4x7;
@@ -89,8 +92,13 @@ static void sensor_info_draw_callback(Canvas* canvas, void* model) {
         SingleWireSensor* s = sensor->instance;
         canvas_draw_str(canvas, 10, 34, "Data pin: ");
 
+        canvas_draw_str(canvas, 10, 45, "Margin:");
+
         canvas_set_font(canvas, FontSecondary);
         canvas_draw_str(canvas, 57, 34, s->data_pin->name);
+        //Timing margin of the last frame
+        furi_string_printf(temp_str, "%lu us", s->timing_margin);
+        canvas_draw_str(canvas, 50, 45, furi_string_get_cstr(temp_str));
     } else if(sensor->model->interface == &unitemp_i2c) {
         I2CSensor* s = sensor->instance;
         canvas_set_font(canvas, FontPrimary);
@@ -98,10 +106,20 @@ static void sensor_info_draw_callback(Canvas* canvas, void* model) {
         canvas_draw_str(canvas, 10, 45, "SDA pin:");
         canvas_draw_str(canvas, 10, 56, "SCL pin:");
         canvas_set_font(canvas, FontSecondary);
-        furi_string_printf(temp_str, "0x%02X", s->current_i2c_adress >> 1);
+        if(s->mux_i2c_adress == 0) {
+            furi_string_printf(temp_str, "0x%02X", s->current_i2c_adress >> 1);
+        } else {
+            //Address behind the multiplexer: address@mux/channel
+            furi_string_printf(
+                temp_str,
+                "0x%02X@%02X/%d",
+                s->current_i2c_adress >> 1,
+                s->mux_i2c_adress >> 1,
+                s->mux_channel);
+        }
         canvas_draw_str(canvas, 76, 34, furi_string_get_cstr(temp_str));
-        canvas_draw_str(canvas, 56, 45, unitemp_gpio_get_from_int(15)->name);
-        canvas_draw_str(canvas, 55, 56, unitemp_gpio_get_from_int(16)->name);
+        canvas_draw_str(canvas, 56, 45, unitemp_i2c_get_sda_pin(s)->name);
+        canvas_draw_str(canvas, 55, 56, unitemp_i2c_get_scl_pin(s)->name);
     } else if(sensor->model->interface == &unitemp_spi) {
         SPISensor* s = sensor->instance;
         canvas_set_font(canvas, FontPrimary);
@@ -113,6 +131,34 @@ static void sensor_info_draw_callback(Canvas* canvas, void* model) {
         canvas_draw_str(canvas, 62, 34, unitemp_gpio_get_from_int(3)->name);
         canvas_draw_str(canvas, 56, 45, unitemp_gpio_get_from_int(5)->name);
         canvas_draw_str(canvas, 49, 56, s->cs_pin->name);
+        if(sensor->model == &MAX31855) {
+            MAX31855_instance* max31855 = s->sensor_instance;
+            //Thermocouple fault or the cold junction temperature
+            if(max31855->fault & MAX31855_FAULT_OC) {
+                furi_string_set(temp_str, "OC");
+            } else if(max31855->fault & MAX31855_FAULT_SCG) {
+                furi_string_set(temp_str, "SCG");
+            } else if(max31855->fault & MAX31855_FAULT_SCV) {
+                furi_string_set(temp_str, "SCV");
+            } else {
+                float cold_junction = max31855->cold_junction;
+                if(app->settings->temperature_unit == UT_TEMP_FAHRENHEIT) {
+                    cold_junction = locale_celsius_to_fahrenheit(cold_junction);
+                }
+                furi_string_printf(temp_str, "CJ %.1f", (double)cold_junction);
+            }
+            canvas_draw_str_aligned(
+                canvas, 119, 45, AlignRight, AlignBottom, furi_string_get_cstr(temp_str));
+        }
+    } else if(sensor->model->interface == &unitemp_virtual) {
+        VirtualSensor* s = sensor->instance;
+        canvas_draw_str(canvas, 10, 34, "Wave:");
+        canvas_draw_str(canvas, 10, 45, "Latency:");
+
+        canvas_set_font(canvas, FontSecondary);
+        canvas_draw_str(canvas, 43, 34, unitemp_virtual_wave_get_name(s->wave));
+        furi_string_printf(temp_str, "%d ms", s->latency);
+        canvas_draw_str(canvas, 56, 45, furi_string_get_cstr(temp_str));
     } else if(sensor->model->interface == &unitemp_1w) {
         OneWireSensor* s = sensor->instance;
         canvas_set_font(canvas, FontPrimary);
@@ -22,6 +22,7 @@
 #include "../interfaces/singlewire_sensor.h"
 #include "../interfaces/i2c_sensor.h"
 #include "../interfaces/spi_sensor.h"
+#include "../interfaces/virtual_sensor.h"
 #include "../interfaces/onewire_sensor.h"
 
 #include <stdlib.h>
@@ -45,6 +46,12 @@ static char* temp_str;
 #define UT_DATA_POS_DOWN_RIGHT  65, 39
 #define UT_DATA_POS_NONE        255, 255
 
+//Plot of the fast capture: right edge, bottom, height and the step between the values
+#define UT_CAPTURE_PLOT_RIGHT  111
+#define UT_CAPTURE_PLOT_BOTTOM 58
+#define UT_CAPTURE_PLOT_HEIGHT 11
+#define UT_CAPTURE_PLOT_STEP   3
+
 //Массив содержит в себе сколько элементов в себе содержит то или иное отображение UT_DATA_TYPE
 static const uint8_t data_types_values_count[UT_DATA_TYPE_COUNT] = {
     1, //UT_DATA_TYPE_TEMP
@@ -81,6 +88,8 @@ static void _draw_sensor_not_responding(Canvas* canvas, Sensor* sensor) {
         snprintf(temp_str, TEMP_STR_SIZE, "Sensor waiting on SDA & SCL");
     } else if(sensor->model->interface == &unitemp_spi) {
         snprintf(temp_str, TEMP_STR_SIZE, "Sensor waiting on SPI pins");
+    } else if(sensor->model->interface == &unitemp_virtual) {
+        snprintf(temp_str, TEMP_STR_SIZE, "Virtual sensor dropout");
     } else if(sensor->model->interface == &unitemp_1w) {
         snprintf(
             temp_str,
@@ -92,6 +101,40 @@ static void _draw_sensor_not_responding(Canvas* canvas, Sensor* sensor) {
     canvas_draw_str_aligned(canvas, 65, 19, AlignCenter, AlignCenter, temp_str);
 }
 
+/**
+ * @brief Draw the values captured in the fast capture mode under the temperature
+ * 
+ * The newest value is at the right edge, the plot is scaled to the range of the values.
+ * @param canvas Pointer to canvas
+ * @param sensor Pointer to sensor
+ */
+static void _draw_spi_capture(Canvas* canvas, Sensor* sensor) {
+    float values[SPI_CAPTURE_SIZE];
+    uint8_t count = unitemp_spi_sensor_get_capture(sensor, values, SPI_CAPTURE_SIZE);
+    if(count < 2) return;
+
+    float min = values[0], max = values[0];
+    for(uint8_t i = 1; i < count; i++) {
+        if(values[i] < min) min = values[i];
+        if(values[i] > max) max = values[i];
+    }
+
+    uint8_t x = UT_CAPTURE_PLOT_RIGHT - (count - 1) * UT_CAPTURE_PLOT_STEP;
+    uint8_t prev_x = 0, prev_y = 0;
+    for(uint8_t i = 0; i < count; i++) {
+        //A flat signal is drawn in the middle
+        uint8_t level = UT_CAPTURE_PLOT_HEIGHT / 2;
+        if(max > min) {
+            level = (uint8_t)((values[i] - min) / (max - min) * UT_CAPTURE_PLOT_HEIGHT + 0.5f);
+        }
+        uint8_t y = UT_CAPTURE_PLOT_BOTTOM - level;
+        if(i > 0) canvas_draw_line(canvas, prev_x, prev_y, x, y);
+        prev_x = x;
+        prev_y = y;
+        x += UT_CAPTURE_PLOT_STEP;
+    }
+}
+
 static void _draw_sensor_polling(Canvas* canvas, Sensor* sensor) {
     UNUSED(sensor);
     canvas_draw_icon(canvas, 34, 23, &I_flipper_happy_60x38);
@@ -140,6 +183,7 @@ void single_sensor_draw_sensor(Canvas* canvas, Sensor* sensor, SingleSensorViewM
                 settings->temperature_unit,
                 values_positions[values_count_index][0][0],
                 values_positions[values_count_index][0][1]);
+            _draw_spi_capture(canvas, sensor);
             break;
         case UT_DATA_TYPE_TEMP_HUM:
             values_count_index += (settings->heat_index ? 1 : 0);